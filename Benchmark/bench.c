@@ -0,0 +1,496 @@
+/* Benchmark runner for the solver variants.
+ *
+ * Compile with:  gcc -O2 -Wall bench.c -o bench
+ * Run with:      ./bench [options] [name=command ...]
+ *
+ * Runs every variant on every instance of a directory, a number
+ * of times each, and records the result, the wall-clock time
+ * on CLOCK_MONOTONIC, the peak resident set size, and the
+ * decisions, propagations and conflicts the solver reports,
+ * one row per run, as CSV or JSON.
+ *
+ * Given a baseline from an earlier run, the fastest times and
+ * the peak RSS of each variant on each instance are compared
+ * against it, and the runner exits with 1 upon any regression,
+ * or any answer differing from the baseline. Timeouts stand for
+ * no answer, and take no part in either: ones in both are alike,
+ * and one answered now is no change. Baselines are compared with
+ * runs of the same time limit only, which is recorded in them.
+ * Decisions and conflicts do not vary from run to run, and flag
+ * any search grown past the tolerance. Times do, by a fifth and
+ * more on a loaded machine, so they are only flagged for variants
+ * reporting no counters, past a tolerance of their own and past
+ * MIN_SLOWDOWN as well, and compared by the fastest of the
+ * repetitions, which noise only slows down.
+ *
+ * Variants are given as name=command, where the command may
+ * carry options, and gets the instance appended to it.
+ * Without any, the four variants in the repository are run.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#define BUFFERSIZE 1024
+#define MAX_ARGS 32
+#define MIN_SLOWDOWN 0.05	// seconds of a fastest run slower than the baseline to flag
+
+typedef
+struct variant_tag {
+	char name[64];
+	char * argv[MAX_ARGS];	// command and its options, NULL-terminated
+	int argc;
+} variant;
+
+typedef
+struct run_tag {
+	const char * variant;
+	const char * instance;
+	int rep;
+	const char * result;	// SAT, UNSAT, UNKNOWN, TIMEOUT or CRASH
+	int status;				// exit code, or signal number if crashed
+	double time;			// seconds
+	long peak_rss;			// kilobytes
+	long long decisions;	// -1 for the ones not reported
+	long long propagations;
+	long long conflicts;
+	double limit;			// CPU seconds the run had
+} run;
+
+typedef
+struct baseline_tag {
+	char variant[64];
+	char instance[BUFFERSIZE];
+	char result[16];
+	double time;
+	long peak_rss;
+	long long decisions;	// -1 if not reported
+	long long conflicts;
+	double limit;			// 0 if not recorded
+} baseline;
+
+double ts_to_sec(struct timespec t)
+{
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+double monotonic_sec(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return ts_to_sec(t);
+}
+
+int compare_strings(const void * a, const void * b)
+{
+	return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+// Splits "name=command opt ..." on spaces, keeping the string
+int parse_variant(char * spec, variant * v)
+{
+	char * eq = strchr(spec, '=');
+	if (eq == NULL || eq - spec >= sizeof v->name) return 0;
+
+	memcpy(v->name, spec, eq - spec);
+	v->name[eq - spec] = '\0';
+
+	v->argc = 0;
+	for (char * tok = strtok(eq + 1, " "); tok != NULL; tok = strtok(NULL, " "))
+		if (v->argc < MAX_ARGS - 2)
+			v->argv[v->argc++] = tok;
+	v->argv[v->argc] = NULL;
+
+	return v->argc > 0;
+}
+
+// Instances are the .cnf files of the directory, in order
+char ** list_instances(const char * dir, int * n)
+{
+	DIR * d = opendir(dir);
+	if (d == NULL) {
+		perror(dir);
+		return NULL;
+	}
+
+	int cap = 16;
+	char ** list = malloc(cap * sizeof * list);
+	struct dirent * e;
+	*n = 0;
+
+	while ((e = readdir(d)) != NULL) {
+		size_t len = strlen(e->d_name);
+		if (len < 5 || strcmp(e->d_name + len - 4, ".cnf") != 0) continue;
+		if (*n == cap) list = realloc(list, (cap *= 2) * sizeof * list);
+		asprintf(&list[(*n)++], "%s/%s", dir, e->d_name);
+	}
+	closedir(d);
+
+	qsort(list, *n, sizeof * list, compare_strings);
+	return list;
+}
+
+// Counters are reported as "Name: N", possibly as "c Name: N"
+long long counter(const char * output, const char * name)
+{
+	const char * p = output;
+	size_t len = strlen(name);
+
+	while ((p = strstr(p, name)) != NULL) {
+		if ((p == output || p[-1] == '\n' || p[-1] == ' ') && p[len] == ':')
+			return atoll(p + len + 1);
+		p += len;
+	}
+	return -1;
+}
+
+const char * result_of(const char * output, int status)
+{
+	if (strstr(output, "s SATISFIABLE") || strstr(output, "Satisfiable!"))
+		return "SAT";
+	if (strstr(output, "s UNSATISFIABLE") || strstr(output, "Unsatisfiable."))
+		return "UNSAT";
+	return "UNKNOWN";
+}
+
+/* Runs a variant on an instance, collecting what the solver
+ * prints on its standard output. The solver gets timeout
+ * seconds of CPU time, after which it is killed.
+ */
+void run_once(variant * v, const char * instance, double timeout, run * r)
+{
+	int fds[2];
+	char * argv[MAX_ARGS];
+	memcpy(argv, v->argv, v->argc * sizeof * argv);
+	argv[v->argc] = (char *) instance;
+	argv[v->argc + 1] = NULL;
+
+	if (pipe(fds) != 0) {
+		perror("pipe");
+		exit(-1);
+	}
+
+	double start = monotonic_sec();
+	pid_t pid = fork();
+	if (pid == 0) {
+		struct rlimit cpu = { (rlim_t) timeout, (rlim_t) timeout + 1 };
+		setrlimit(RLIMIT_CPU, &cpu);
+		dup2(fds[1], STDOUT_FILENO);
+		close(fds[0]);
+		close(fds[1]);
+		execvp(argv[0], argv);
+		perror(argv[0]);
+		_exit(127);
+	}
+	close(fds[1]);
+
+	size_t len = 0, cap = 1 << 16;
+	char * output = malloc(cap);
+	ssize_t n;
+	while ((n = read(fds[0], output + len, cap - len - 1)) > 0)
+		if ((len += n) + 1 == cap) output = realloc(output, cap *= 2);
+	output[len] = '\0';
+	close(fds[0]);
+
+	int status;
+	struct rusage usage;
+	wait4(pid, &status, 0, &usage);
+
+	r->time = monotonic_sec() - start;
+	r->peak_rss = usage.ru_maxrss;
+	r->decisions = counter(output, "Decisions");
+	r->propagations = counter(output, "Propagations");
+	r->conflicts = counter(output, "Conflicts");
+
+	if (WIFSIGNALED(status)) {
+		r->status = WTERMSIG(status);
+		r->result = (r->status == SIGXCPU || r->status == SIGKILL) ? "TIMEOUT" : "CRASH";
+	}
+	else {
+		r->status = WEXITSTATUS(status);
+		r->result = result_of(output, r->status);
+	}
+
+	free(output);
+}
+
+void print_csv_header(FILE * fp)
+{
+	fputs("variant,instance,rep,result,status,time_s,peak_rss_kb,decisions,propagations,conflicts,time_limit_s\n", fp);
+}
+
+void print_csv(FILE * fp, run * r)
+{
+	fprintf(fp, "%s,%s,%d,%s,%d,%.6f,%ld,%lld,%lld,%lld,%g\n",
+		r->variant, r->instance, r->rep, r->result, r->status,
+		r->time, r->peak_rss, r->decisions, r->propagations, r->conflicts, r->limit);
+}
+
+void print_json(FILE * fp, run * r, int first)
+{
+	fprintf(fp, "%s\n  {\"variant\": \"%s\", \"instance\": \"%s\", \"rep\": %d, "
+		"\"result\": \"%s\", \"status\": %d, \"time_s\": %.6f, \"peak_rss_kb\": %ld, "
+		"\"decisions\": %lld, \"propagations\": %lld, \"conflicts\": %lld, \"time_limit_s\": %g}",
+		first ? "" : ",", r->variant, r->instance, r->rep, r->result, r->status,
+		r->time, r->peak_rss, r->decisions, r->propagations, r->conflicts, r->limit);
+}
+
+/* Baselines are results in CSV, as this runner writes them.
+ * Repetitions are folded into their fastest time and the
+ * highest peak RSS, the same way the new runs are. Ones written
+ * before the time limit was recorded have it as 0.
+ */
+baseline * read_baseline(const char * path, int * n)
+{
+	FILE * fp = fopen(path, "r");
+	if (fp == NULL) {
+		perror(path);
+		return NULL;
+	}
+
+	char line[BUFFERSIZE];
+	int cap = 64;
+	baseline * rows = malloc(cap * sizeof * rows);
+	*n = 0;
+
+	while (fgets(line, sizeof line, fp) != NULL) {
+		baseline b;
+		int rep, status;
+		long long counters[3];
+		if (sscanf(line, "%63[^,],%1023[^,],%d,%15[^,],%d,%lf,%ld",
+			b.variant, b.instance, &rep, b.result, &status, &b.time, &b.peak_rss) != 7)
+			continue; // the header
+		int n_fields = sscanf(line, "%*[^,],%*[^,],%*d,%*[^,],%*d,%*f,%*d,%lld,%lld,%lld,%lf",
+			&counters[0], &counters[1], &counters[2], &b.limit);
+		if (n_fields < 4) b.limit = 0;
+		b.decisions = (n_fields >= 3) ? counters[0] : -1;
+		b.conflicts = (n_fields >= 3) ? counters[2] : -1;
+
+		if (*n == cap) rows = realloc(rows, (cap *= 2) * sizeof * rows);
+		rows[(*n)++] = b;
+	}
+
+	fclose(fp);
+	return rows;
+}
+
+/* Fastest time, and highest peak RSS, decisions and conflicts, of
+ * the rows matching a variant and an instance, into the one given.
+ */
+int summarize(baseline * rows, int n, const char * v, const char * inst, baseline * sum)
+{
+	int k = 0;
+	sum->peak_rss = 0;
+	sum->decisions = sum->conflicts = -1;
+
+	for (int i = 0; i < n; i++) {
+		if (strcmp(rows[i].variant, v) || strcmp(rows[i].instance, inst)) continue;
+		if (k++ == 0 || rows[i].time < sum->time) sum->time = rows[i].time;
+		if (rows[i].peak_rss > sum->peak_rss) sum->peak_rss = rows[i].peak_rss;
+		if (rows[i].decisions > sum->decisions) sum->decisions = rows[i].decisions;
+		if (rows[i].conflicts > sum->conflicts) sum->conflicts = rows[i].conflicts;
+		snprintf(sum->result, sizeof sum->result, "%s", rows[i].result);
+	}
+
+	return k;
+}
+
+// Tells whether a counter reported in both grew past the tolerance
+int grew(long long now, long long base, double tolerance)
+{
+	return now >= 0 && base >= 0 && now > base * (1 + tolerance) && now - base > 1;
+}
+
+/* Flags the searches and peak RSS grown past the tolerance, and, of
+ * the variants reporting no counters, the fastest runs that got slower
+ * than the baseline by more than the slowdown, ignoring differences
+ * below min_time seconds that are within the noise.
+ */
+int compare_baseline(baseline * now, int n_now, baseline * base, int n_base,
+	double tolerance, double slowdown, double min_time)
+{
+	int regressions = 0;
+
+	for (int i = 0; i < n_now; i++) {
+		int seen = 0;
+		for (int j = 0; j < i; j++)
+			seen |= !strcmp(now[j].variant, now[i].variant) && !strcmp(now[j].instance, now[i].instance);
+		if (seen) continue;
+
+		baseline a, b;
+		summarize(now, n_now, now[i].variant, now[i].instance, &a);
+		if (!summarize(base, n_base, now[i].variant, now[i].instance, &b))
+			continue;
+
+		double t_now = a.time, t_base = b.time;
+		long rss_now = a.peak_rss, rss_base = b.peak_rss;
+		const char * res_now = a.result, * res_base = b.result;
+		int timeout_now = !strcmp(res_now, "TIMEOUT"), timeout_base = !strcmp(res_base, "TIMEOUT");
+		const char * verdict = "ok";
+		if (timeout_base)
+			verdict = timeout_now ? "ok" : "ok, answered";
+		else if (timeout_now)
+			verdict = "TIMEOUT";
+		else if (strcmp(res_now, res_base) != 0)
+			verdict = "DIFFERENT RESULT";
+		else if (grew(a.decisions, b.decisions, tolerance) || grew(a.conflicts, b.conflicts, tolerance))
+			verdict = "MORE SEARCH";
+		else if ((a.decisions < 0 || b.decisions < 0) && t_now > t_base * (1 + slowdown) && t_now - t_base > min_time)
+			verdict = "SLOWER";
+		else if (rss_now > rss_base * (1 + tolerance) && rss_now - rss_base > 1024)
+			verdict = "MORE MEMORY";
+
+		if (strncmp(verdict, "ok", 2) != 0) regressions++;
+		printf("%-12s %-32s %9.4fs %9.4fs %+7.1f%% %8ldK %8ldK  %s\n",
+			now[i].variant, now[i].instance, t_base, t_now,
+			t_base > 0 ? 100 * (t_now - t_base) / t_base : 0.0,
+			rss_base, rss_now, verdict);
+	}
+
+	return regressions;
+}
+
+void usage(const char * prog)
+{
+	fprintf(stderr, "Usage: %s [options] [name=command ...]\n", prog);
+	fputs(
+		"Options:\n"
+		"  -d DIR    directory of the instances (default SATproblem)\n"
+		"  -r N      repetitions of each run (default 3)\n"
+		"  -t SEC    CPU time limit of each run (default 60)\n"
+		"  -o FILE   results, as JSON if FILE ends with .json, CSV otherwise\n"
+		"  -b FILE   baseline in CSV to compare the results against\n"
+		"  -p PCT    tolerance for regressions in percent (default 10)\n"
+		"  -s PCT    tolerance for slowdowns in percent (default 25)\n"
+		"Default variants are satsolver, satsolver2, and satsolver3 searching\n"
+		"breadth-first and depth-first, all from the current directory.\n",
+		stderr);
+}
+
+int main(int argc, char * argv[])
+{
+	const char * dir = "SATproblem";
+	const char * out_path = NULL;
+	const char * base_path = NULL;
+	int reps = 3;
+	double timeout = 60;
+	double tolerance = 0.10;
+	double slowdown = 0.25;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "d:r:t:o:b:p:s:h")) != -1) switch (opt) {
+		case 'd': dir = optarg; break;
+		case 'r': reps = atoi(optarg); break;
+		case 't': timeout = atof(optarg); break;
+		case 'o': out_path = optarg; break;
+		case 'b': base_path = optarg; break;
+		case 'p': tolerance = atof(optarg) / 100; break;
+		case 's': slowdown = atof(optarg) / 100; break;
+		default:
+			usage(argv[0]);
+			return -1;
+	}
+
+	char defaults[][64] = {
+		"s1=./satsolver",
+		"s2=./satsolver2",
+		"s3-breadth=./satsolver3 --breadth",
+		"s3-depth=./satsolver3 --depth",
+	};
+	int n_variants = (optind < argc) ? argc - optind : sizeof defaults / sizeof * defaults;
+	variant * variants = malloc(n_variants * sizeof * variants);
+	for (int i = 0; i < n_variants; i++) {
+		char * spec = (optind < argc) ? argv[optind + i] : defaults[i];
+		if (!parse_variant(spec, &variants[i])) {
+			fprintf(stderr, "Variant %s is not of the form name=command\n", spec);
+			return -1;
+		}
+	}
+
+	int n_instances;
+	char ** instances = list_instances(dir, &n_instances);
+	if (instances == NULL) return -1;
+
+	FILE * out = NULL;
+	int json = 0;
+	if (out_path != NULL) {
+		size_t len = strlen(out_path);
+		json = len > 5 && strcmp(out_path + len - 5, ".json") == 0;
+		if ((out = fopen(out_path, "w")) == NULL) {
+			perror(out_path);
+			return -1;
+		}
+		if (json) fputs("[", out);
+		else print_csv_header(out);
+	}
+
+	int n_runs = n_variants * n_instances * reps;
+	baseline * summary = malloc(n_runs * sizeof * summary);
+	int k = 0;
+
+	print_csv_header(stdout);
+	for (int v = 0; v < n_variants; v++)
+	for (int i = 0; i < n_instances; i++)
+	for (int rep = 1; rep <= reps; rep++) {
+		run r = { variants[v].name, instances[i], rep };
+		r.limit = timeout;
+		run_once(&variants[v], instances[i], timeout, &r);
+
+		print_csv(stdout, &r);
+		fflush(stdout);
+		if (out != NULL) {
+			if (json) print_json(out, &r, k == 0);
+			else print_csv(out, &r);
+		}
+
+		baseline * b = &summary[k++];
+		snprintf(b->variant, sizeof b->variant, "%s", r.variant);
+		snprintf(b->instance, sizeof b->instance, "%s", r.instance);
+		snprintf(b->result, sizeof b->result, "%s", r.result);
+		b->time = r.time;
+		b->peak_rss = r.peak_rss;
+		b->decisions = r.decisions;
+		b->conflicts = r.conflicts;
+	}
+
+	if (out != NULL) {
+		if (json) fputs("\n]\n", out);
+		fclose(out);
+	}
+
+	int regressions = 0;
+	if (base_path != NULL) {
+		int n_base;
+		baseline * base = read_baseline(base_path, &n_base);
+		if (base == NULL) return -1;
+
+		// times and timeouts under another limit tell nothing of these
+		for (int i = 0; i < n_base; i++)
+			if (base[i].limit != 0 && base[i].limit != timeout) {
+				fprintf(stderr, "Baseline %s was taken with -t %g, not -t %g\n", base_path, base[i].limit, timeout);
+				free(base);
+				return -1;
+			}
+
+		printf("\n%-12s %-32s %10s %10s %8s %9s %9s\n",
+			"variant", "instance", "baseline", "now", "change", "base rss", "rss");
+		regressions = compare_baseline(summary, k, base, n_base, tolerance, slowdown, MIN_SLOWDOWN);
+		printf("%d regression(s)\n", regressions);
+		free(base);
+	}
+
+	for (int i = 0; i < n_instances; i++) free(instances[i]);
+	free(instances);
+	free(variants);
+	free(summary);
+
+	return regressions ? 1 : 0;
+}
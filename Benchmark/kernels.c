@@ -0,0 +1,271 @@
+/* Microbenchmarks of the bitmap kernels of satsolver3.
+ *
+ * Compile with:  gcc -O2 -Wall kernels.c -o kernels -lpthread
+ *          or:   gcc -O2 -Wall -DBITSTORE_BITS=64 kernels.c -o kernels64 -lpthread
+ * Run with:      ./kernels [-t SEC] [-f FILTER]
+ *
+ * The solver library is included as a whole, so the kernels
+ * are measured exactly as the solver compiles them.
+ * Each kernel runs on random 3-SAT and wider formulas of a few
+ * shapes, with a third of the variables assigned, for as many
+ * iterations as it takes to fill the minimum time, and the time
+ * per call is reported the way Google Benchmark does.
+ */
+#include "../sat3.c"
+
+typedef
+struct shape_tag {
+	unsigned int vars;
+	double ratio;	// clauses per variable
+	int k;			// literals per clause
+} shape;
+
+typedef
+struct kernel_tag {
+	const char * name;
+	uint64_t (* run)(bitstore * config, uint64_t iters);
+} kernel;
+
+/* ==== Formula Functions ==== */
+formula * f;	// formula of the current shape
+solver s;		// with a solver over it, for the kernels counting stats
+
+uint64_t rng_state = 1;
+
+uint64_t rng_next(void)
+{
+	uint64_t z = (rng_state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+// Builds a random formula in place of one read from a file
+void make_formula(shape sh)
+{
+	int n_clauses = round_pos(sh.ratio * sh.vars);
+	int * clause = malloc(sh.k * sizeof * clause);
+
+	f = formula_new();
+	formula_add_vars(f, sh.vars);
+
+	for (int c = 1; c <= n_clauses; c++) {
+		int n = 0;
+		for (int i = 0; i < sh.k; i++) {
+			int var = 1 + rng_next() % sh.vars;
+			int dup = 0;
+			for (int j = 0; j < n; j++)
+				dup |= abs(clause[j]) == var;
+			if (!dup) clause[n++] = (rng_next() & 1) ? var : -var;
+		}
+		formula_add_clause(f, clause, n);
+	}
+
+	free(clause);
+	solver_init(&s, f);
+}
+
+// A configuration midway through a search, a third of the variables assigned
+bitstore * make_config(void)
+{
+	bitstore * config = calloc(f->cfg_len, sizeof * config);
+	for (unsigned int var = 1; var <= f->n_vars; var++)
+		if (rng_next() % 3 == 0)
+			lit_assign(&s, config, (rng_next() & 1) ? (int) var : -(int) var);
+	return config;
+}
+
+/* ==== Kernel Functions ==== */
+/* Each one calls its kernel iters times, cycling through the
+ * clauses or literals, and returns a sum of the results so
+ * that the calls cannot be optimised away.
+ */
+uint64_t run_lit_propagate(bitstore * config, uint64_t iters)
+{
+	bitstore * cconf = calloc(f->cconf_len, sizeof * cconf);
+	int var = 1;
+
+	for (uint64_t i = 0; i < iters; i++) {
+		lit_propagate(&s, cconf, (i & 1) ? var : -var);
+		if (++var > f->n_vars) {
+			var = 1;
+			memset(cconf, 0, f->cconf_len * sizeof * cconf);
+		}
+	}
+
+	uint64_t sum = cconf[0];
+	free(cconf);
+	return sum;
+}
+
+uint64_t run_clause_length(bitstore * config, uint64_t iters)
+{
+	uint64_t sum = 0;
+	int c = 1;
+
+	for (uint64_t i = 0; i < iters; i++) {
+		sum += clause_length(f, config, c);
+		if (++c > f->n_clauses) c = 1;
+	}
+	return sum;
+}
+
+uint64_t run_get_unit(bitstore * config, uint64_t iters)
+{
+	uint64_t sum = 0;
+	int c = 1;
+
+	for (uint64_t i = 0; i < iters; i++) {
+		sum += get_unit(f, config, c);
+		if (++c > f->n_clauses) c = 1;
+	}
+	return sum;
+}
+
+uint64_t run_lit_occurrence_count(bitstore * config, uint64_t iters)
+{
+	uint64_t sum = 0;
+	int var = 1;
+
+	for (uint64_t i = 0; i < iters; i++) {
+		sum += lit_occurrence_count(f, config, (i & 1) ? var : -var);
+		if (++var > f->n_vars) var = 1;
+	}
+	return sum;
+}
+
+uint64_t run_sat_count(bitstore * config, uint64_t iters)
+{
+	uint64_t sum = 0;
+	for (uint64_t i = 0; i < iters; i++)
+		sum += sat_count(f, config);
+	return sum;
+}
+
+// Over the words of the configuration, as the solver sees them
+uint64_t run_count_bits(bitstore * config, uint64_t iters)
+{
+	uint64_t sum = 0;
+	for (uint64_t i = 0; i < iters; i++)
+		sum += count_bits(config[i % f->cfg_len] ^ i);
+	return sum;
+}
+
+uint64_t run_least_bit_pos(bitstore * config, uint64_t iters)
+{
+	uint64_t sum = 0;
+	for (uint64_t i = 0; i < iters; i++)
+		sum += least_bit_pos((config[i % f->cfg_len] ^ i) | bit(sbitstore - 1));
+	return sum;
+}
+
+// A whole step of reductions, on a fresh copy each time
+uint64_t run_dpll_step(bitstore * config, uint64_t iters)
+{
+	uint64_t sum = 0;
+	for (uint64_t i = 0; i < iters; i++) {
+		bitstore * copy = copy_config(f, config);
+		sum += dpll_step(&s, copy);
+		free(copy);
+	}
+	return sum;
+}
+
+// All clauses in 64 random assignments at once, the cost per assignment is a 64th
+uint64_t run_lanes_eval(bitstore * config, uint64_t iters)
+{
+	int n_planes = lanes_planes(f);
+	uint64_t * values = malloc((f->n_vars + 1) * sizeof * values);
+	uint64_t * planes = malloc(n_planes * sizeof * planes);
+	uint64_t rng = 1, sum = 0;
+
+	lanes_random(f, &rng, NULL, 0, values);
+	for (uint64_t i = 0; i < iters; i++) {
+		values[1 + i % f->n_vars] ^= i;
+		sum += lanes_eval(f, values, planes, n_planes) + planes[0];
+	}
+
+	free(values);
+	free(planes);
+	return sum;
+}
+
+/* ==== Runner Functions ==== */
+volatile uint64_t sink;
+
+/* Doubles the iterations until a run lasts min_time, like
+ * Google Benchmark, and returns the nanoseconds per call.
+ */
+double measure(kernel * k, bitstore * config, double min_time, uint64_t * iters)
+{
+	double elapsed = 0;
+
+	for (*iters = 1; ; *iters *= 2) {
+		double start = monotonic_sec();
+		sink += k->run(config, *iters);
+		elapsed = monotonic_sec() - start;
+		if (elapsed >= min_time || *iters >= (1ULL << 40)) break;
+	}
+
+	return elapsed * 1e9 / *iters;
+}
+
+int main(int argc, char * argv[])
+{
+	double min_time = 0.1;
+	const char * filter = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-t") && i + 1 < argc) min_time = atof(argv[++i]);
+		else if (!strcmp(argv[i], "-f") && i + 1 < argc) filter = argv[++i];
+		else {
+			fprintf(stderr, "Usage: %s [-t SEC] [-f FILTER]\n", argv[0]);
+			return -1;
+		}
+	}
+
+	shape shapes[] = {
+		{   100, 4.26, 3 },
+		{  1000, 4.26, 3 },
+		{ 10000, 4.26, 3 },
+		{  1000, 20.0, 3 },	// dense, many occurrences per variable
+		{  1000, 2.00, 7 },	// wide clauses
+	};
+	kernel kernels[] = {
+		{ "lit_propagate",        run_lit_propagate },
+		{ "clause_length",        run_clause_length },
+		{ "get_unit",             run_get_unit },
+		{ "lit_occurrence_count", run_lit_occurrence_count },
+		{ "sat_count",            run_sat_count },
+		{ "count_bits",           run_count_bits },
+		{ "least_bit_pos",        run_least_bit_pos },
+		{ "dpll_step",            run_dpll_step },
+		{ "lanes_eval",           run_lanes_eval },
+	};
+
+	printf("Words of %d bits, at least %gs per benchmark\n", BITSTORE_BITS, min_time);
+	printf("%-48s %14s %14s\n", "Benchmark", "Time", "Iterations");
+
+	for (int sh = 0; sh < sizeof shapes / sizeof * shapes; sh++) {
+		make_formula(shapes[sh]);
+		bitstore * config = make_config();
+
+		for (int k = 0; k < sizeof kernels / sizeof * kernels; k++) {
+			char name[BUFFERSIZE];
+			snprintf(name, sizeof name, "%s/%u/%u/%d", kernels[k].name,
+				f->n_vars, f->n_clauses, shapes[sh].k);
+			if (filter != NULL && strstr(name, filter) == NULL) continue;
+
+			uint64_t iters;
+			double ns = measure(&kernels[k], config, min_time, &iters);
+			printf("%-48s %11.1f ns %14llu\n", name, ns, (unsigned long long) iters);
+			fflush(stdout);
+		}
+
+		free(config);
+		solver_clean(&s);
+		formula_free(f);
+	}
+
+	return 0;
+}
@@ -0,0 +1,294 @@
+/* Instance generator in DIMACS CNF.
+ *
+ * Compile with:  gcc -O2 -Wall gen.c -o gen
+ * Run with:      ./gen FAMILY [options] > instance.cnf
+ *
+ * Families:
+ *   random   uniform random k-SAT over n variables, with m clauses
+ *            or m = ratio * n of them (4.26 is the 3-SAT threshold)
+ *   php      pigeonhole principle, n+1 pigeons into n holes (UNSAT)
+ *   color    k-colouring of a random graph over n vertices and m edges
+ *   parity   m random XOR constraints of length k over n variables,
+ *            cut into chunks of three with auxiliary variables
+ *
+ * The same seed gives the same instance on any platform, as the
+ * random numbers come from splitmix64 rather than rand().
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define BUFFERSIZE (1 << 16)
+
+typedef
+struct options_tag {
+	const char * family;
+	long n;			// variables, holes or vertices
+	long m;			// clauses, edges or constraints; 0 to derive from ratio
+	int k;			// literals per clause, colours or XOR length
+	double ratio;
+	uint64_t seed;
+	const char * output;
+} options;
+
+/* ==== Random Number Functions ==== */
+
+uint64_t rng_state;
+
+uint64_t rng_next(void)
+{
+	uint64_t z = (rng_state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+// Uniform in [0, n), without the modulo bias
+uint64_t rng_below(uint64_t n)
+{
+	uint64_t limit = UINT64_MAX - UINT64_MAX % n;
+	uint64_t x;
+	while ((x = rng_next()) >= limit);
+	return x % n;
+}
+
+/* ==== Output Functions ==== */
+
+FILE * out;
+char buffer[BUFFERSIZE];
+size_t buffer_len;
+
+void flush_buffer(void)
+{
+	fwrite(buffer, 1, buffer_len, out);
+	buffer_len = 0;
+}
+
+void put_lit(long lit)
+{
+	char digits[24];
+	int len = 0;
+	unsigned long x = lit < 0 ? -lit : lit;
+
+	if (buffer_len + sizeof digits > BUFFERSIZE) flush_buffer();
+	if (lit < 0) buffer[buffer_len++] = '-';
+	do digits[len++] = '0' + x % 10; while (x /= 10);
+	while (len) buffer[buffer_len++] = digits[--len];
+	buffer[buffer_len++] = lit ? ' ' : '\n';
+}
+
+void put_clause(const long * lits, int n)
+{
+	for (int i = 0; i < n; i++) put_lit(lits[i]);
+	put_lit(0);
+}
+
+void put_header(const options * o, long vars, long clauses)
+{
+	fprintf(out, "c generated by gen %s -n %ld -m %ld -k %d -s %llu\n",
+		o->family, o->n, o->m, o->k, (unsigned long long) o->seed);
+	fprintf(out, "p cnf %ld %ld\n", vars, clauses);
+}
+
+/* ==== Family Functions ==== */
+
+// Picks k distinct variables of 1..n, by rejection as k is small
+void pick_vars(long * vars, int k, long n)
+{
+	for (int i = 0; i < k; i++) {
+		int fresh;
+		do {
+			vars[i] = 1 + rng_below(n);
+			fresh = 1;
+			for (int j = 0; j < i; j++) fresh &= vars[j] != vars[i];
+		} while (!fresh);
+	}
+}
+
+void gen_random(options * o)
+{
+	long lits[o->k];
+
+	if (o->m == 0) o->m = (long) (o->ratio * o->n + 0.5);
+	put_header(o, o->n, o->m);
+
+	for (long c = 0; c < o->m; c++) {
+		pick_vars(lits, o->k, o->n);
+		for (int i = 0; i < o->k; i++)
+			if (rng_next() & 1) lits[i] = -lits[i];
+		put_clause(lits, o->k);
+	}
+}
+
+/* Variable p*n+h+1 places pigeon p into hole h. Each pigeon
+ * is in some hole, and no two pigeons share a hole.
+ */
+void gen_php(options * o)
+{
+	long holes = o->n, pigeons = o->n + 1;
+	long * lits = malloc(holes * sizeof * lits);
+
+	put_header(o, pigeons * holes, pigeons + holes * pigeons * (pigeons - 1) / 2);
+
+	for (long p = 0; p < pigeons; p++) {
+		for (long h = 0; h < holes; h++) lits[h] = p * holes + h + 1;
+		put_clause(lits, holes);
+	}
+	for (long h = 0; h < holes; h++)
+	for (long p = 0; p < pigeons; p++)
+	for (long q = p + 1; q < pigeons; q++) {
+		long pair[2] = { -(p * holes + h + 1), -(q * holes + h + 1) };
+		put_clause(pair, 2);
+	}
+
+	free(lits);
+}
+
+/* Variable v*k+c+1 gives vertex v colour c. Each vertex gets
+ * exactly one colour, and the ends of each edge differ.
+ * Edges are drawn uniformly, skipping loops, so m may repeat some.
+ */
+void gen_color(options * o)
+{
+	long n = o->n;
+	int k = o->k;
+	long * lits = malloc(k * sizeof * lits);
+
+	if (o->m == 0) o->m = (long) (o->ratio * n + 0.5);
+	put_header(o, n * k, n + n * k * (k - 1) / 2 + o->m * k);
+
+	for (long v = 0; v < n; v++) {
+		for (int c = 0; c < k; c++) lits[c] = v * k + c + 1;
+		put_clause(lits, k);
+		for (int c = 0; c < k; c++)
+		for (int d = c + 1; d < k; d++) {
+			long pair[2] = { -(v * k + c + 1), -(v * k + d + 1) };
+			put_clause(pair, 2);
+		}
+	}
+	for (long e = 0; e < o->m; e++) {
+		long ends[2];
+		pick_vars(ends, 2, n);
+		for (int c = 0; c < k; c++) {
+			long pair[2] = { -((ends[0] - 1) * k + c + 1), -((ends[1] - 1) * k + c + 1) };
+			put_clause(pair, 2);
+		}
+	}
+
+	free(lits);
+}
+
+// All 2^(n-1) clauses of v[0] ^ ... ^ v[n-1] = parity
+void put_xor(const long * vars, int n, int parity)
+{
+	long lits[n];
+
+	for (int signs = 0; signs < 1 << n; signs++) {
+		// each clause forbids one assignment of the wrong parity
+		if (__builtin_parity(signs) == parity) continue;
+		for (int i = 0; i < n; i++)
+			lits[i] = (signs >> i & 1) ? -vars[i] : vars[i];
+		put_clause(lits, n);
+	}
+}
+
+/* Each constraint x1 ^ ... ^ xk = b becomes the chain
+ * x1 ^ x2 ^ t1 = 0, t1 ^ x3 ^ t2 = 0, ..., t(k-2) ^ xk = b,
+ * of k-2 XORs over three variables and one over two.
+ */
+void gen_parity(options * o)
+{
+	int k = o->k;
+	long vars[k];
+	long aux = o->n;
+
+	if (o->m == 0) o->m = (long) (o->ratio * o->n + 0.5);
+	put_header(o, o->n + o->m * (k - 2), o->m * ((k - 2) * 4 + 2));
+
+	for (long c = 0; c < o->m; c++) {
+		pick_vars(vars, k, o->n);
+		int parity = rng_next() & 1;
+		long acc = vars[0];
+		for (int i = 1; i < k - 1; i++) {
+			long xor3[3] = { acc, vars[i], ++aux };
+			put_xor(xor3, 3, 0);
+			acc = aux;
+		}
+		long xor2[2] = { acc, vars[k - 1] };
+		put_xor(xor2, 2, parity);
+	}
+}
+
+/* ==== Command-line Functions ==== */
+
+void usage(const char * prog)
+{
+	fprintf(stderr, "Usage: %s random|php|color|parity [options]\n", prog);
+	fputs(
+		"Options:\n"
+		"  -n N      variables, holes or vertices (default 100)\n"
+		"  -m M      clauses, edges or XOR constraints (default ratio * n)\n"
+		"  -k K      literals per clause, colours or XOR length (default 3)\n"
+		"  -r R      clause/variable or edge/vertex ratio (default 4.26)\n"
+		"  -s SEED   seed of the random numbers (default 1)\n"
+		"  -o FILE   output file (default standard output)\n",
+		stderr);
+}
+
+int main(int argc, char * argv[])
+{
+	options o = { NULL, 100, 0, 3, 4.26, 1, NULL };
+
+	if (argc < 2) {
+		usage(argv[0]);
+		return -1;
+	}
+	o.family = argv[1];
+
+	for (int i = 2; i < argc; i++) {
+		const char * value = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (value == NULL || argv[i][0] != '-' || argv[i][2] != '\0') {
+			usage(argv[0]);
+			return -1;
+		}
+		switch (argv[i][1]) {
+			case 'n': o.n = atol(value); break;
+			case 'm': o.m = atol(value); break;
+			case 'k': o.k = atoi(value); break;
+			case 'r': o.ratio = atof(value); break;
+			case 's': o.seed = strtoull(value, NULL, 10); break;
+			case 'o': o.output = value; break;
+			default:
+				usage(argv[0]);
+				return -1;
+		}
+		i++;
+	}
+
+	if (o.n < 1 || o.k < 1 || o.m < 0) {
+		fprintf(stderr, "Sizes must be positive\n");
+		return -1;
+	}
+
+	out = stdout;
+	if (o.output != NULL && (out = fopen(o.output, "w")) == NULL) {
+		perror(o.output);
+		return -1;
+	}
+	rng_state = o.seed;
+
+	if (!strcmp(o.family, "random") && o.k <= o.n) gen_random(&o);
+	else if (!strcmp(o.family, "php")) gen_php(&o);
+	else if (!strcmp(o.family, "color") && o.n >= 2) gen_color(&o);
+	else if (!strcmp(o.family, "parity") && o.k >= 2 && o.k <= o.n) gen_parity(&o);
+	else {
+		usage(argv[0]);
+		return -1;
+	}
+
+	flush_buffer();
+	if (out != stdout) fclose(out);
+
+	return 0;
+}
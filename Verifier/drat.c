@@ -0,0 +1,498 @@
+/* Forward checker for DRAT proofs of unsatisfiability,
+ * as written by satsolver3 with --proof.
+ *
+ * Compile with:  gcc -O2 drat.c -o drat
+ * Run with:      ./drat problem.cnf problem.drat
+ *
+ * Proofs may be either in the text or in the binary format,
+ * which is told apart by the bytes of the proof. Every lemma
+ * is checked as it comes, first for being RUP and if not so
+ * for being RAT on its first literal, until the empty clause.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define BUFFERSIZE 1024
+
+/* Clauses live in a single arena, each one laid out as
+ * its size, its deleted flag, and then its literals.
+ * Literals are coded as 2 * var + sign, to index arrays.
+ */
+#define c_size(c)    (arena[c])
+#define c_deleted(c) (arena[(c) + 1])
+#define c_lits(c)    (arena + (c) + 2)
+#define code(lit)    (2 * abs(lit) + ((lit) < 0))
+#define neg(code)    ((code) ^ 1)
+
+typedef
+struct vector_tag {
+	int * items;
+	size_t len;
+	size_t cap;
+} vector;
+
+int n_vars;
+int n_clauses;
+
+int * arena;
+size_t arena_len;
+size_t arena_cap;
+
+vector * watches;	// clauses watching each literal code
+vector * occurs;	// clauses having each literal code, for RAT
+vector units;		// clauses of size one
+vector * buckets;	// clauses by the hash of their literals
+size_t n_buckets;
+
+char * vals;		// 1 for true literal codes, per check
+vector trail;
+
+void push(vector * v, int x)
+{
+	if (v->len == v->cap) {
+		v->cap = v->cap ? 2 * v->cap : 4;
+		v->items = realloc(v->items, v->cap * sizeof * v->items);
+	}
+	v->items[v->len++] = x;
+}
+
+int compare_ints(const void * a, const void * b)
+{
+	return *(const int *) a - *(const int *) b;
+}
+
+// Order-independent hash of a clause, for finding it on deletion
+size_t clause_hash(const int * lits, int n)
+{
+	size_t sum = 0, prod = 1, x = 0;
+	for (int i = 0; i < n; i++) {
+		sum += lits[i];
+		prod *= (size_t) lits[i] * 2 + 1;
+		x ^= (size_t) lits[i];
+	}
+	return ((1023 * sum + prod) ^ (31 * x)) % n_buckets;
+}
+
+/* Sorts the literals and drops the duplicates, keeping the
+ * first one in front since it is the pivot for RAT.
+ */
+int normalize(int * lits, int n)
+{
+	if (n < 2) return n;
+
+	qsort(lits + 1, n - 1, sizeof * lits, compare_ints);
+	int m = 1;
+	for (int i = 1; i < n; i++)
+		if (lits[i] != lits[0] && lits[i] != lits[m - 1])
+			lits[m++] = lits[i];
+	if (m > 1 && lits[1] == lits[0]) m--;
+
+	return m;
+}
+
+void add_clause(const int * lits, int n)
+{
+	while (arena_len + n + 2 > arena_cap) {
+		arena_cap *= 2;
+		arena = realloc(arena, arena_cap * sizeof * arena);
+	}
+
+	int c = arena_len;
+	c_size(c) = n;
+	c_deleted(c) = 0;
+	memcpy(c_lits(c), lits, n * sizeof * lits);
+	arena_len += n + 2;
+
+	for (int i = 0; i < n; i++)
+		push(&occurs[code(lits[i])], c);
+
+	if (n == 1) push(&units, c);
+	if (n >= 2) {
+		push(&watches[code(lits[0])], c);
+		push(&watches[code(lits[1])], c);
+	}
+	push(&buckets[clause_hash(lits, n)], c);
+}
+
+int same_clause(int c, const int * lits, int n)
+{
+	if (c_size(c) != n) return 0;
+
+	// both are sorted but for their first literal
+	int * a = malloc(n * sizeof * a);
+	int * b = malloc(n * sizeof * b);
+	memcpy(a, c_lits(c), n * sizeof * a);
+	memcpy(b, lits, n * sizeof * b);
+	qsort(a, n, sizeof * a, compare_ints);
+	qsort(b, n, sizeof * b, compare_ints);
+	int same = memcmp(a, b, n * sizeof * a) == 0;
+	free(a);
+	free(b);
+
+	return same;
+}
+
+// Deletes a copy of the clause, returns 0 if there is none
+int delete_clause(const int * lits, int n)
+{
+	vector * bucket = &buckets[clause_hash(lits, n)];
+
+	for (size_t i = 0; i < bucket->len; i++) {
+		int c = bucket->items[i];
+		if (!same_clause(c, lits, n)) continue;
+
+		// watches drop deleted clauses lazily
+		c_deleted(c) = 1;
+		bucket->items[i] = bucket->items[--bucket->len];
+		return 1;
+	}
+
+	return 0;
+}
+
+/* ==== Unit Propagation ==== */
+// Returns 0 if the literal is already false
+int assign(int lit_code)
+{
+	if (vals[neg(lit_code)]) return 0;
+	if (!vals[lit_code]) {
+		vals[lit_code] = 1;
+		push(&trail, lit_code);
+	}
+	return 1;
+}
+
+void unassign_all(void)
+{
+	for (size_t i = 0; i < trail.len; i++)
+		vals[trail.items[i]] = 0;
+	trail.len = 0;
+}
+
+// Returns 1 upon a conflict, with two watched literals per clause
+int propagate(void)
+{
+	for (size_t head = 0; head < trail.len; head++) {
+		int falsified = neg(trail.items[head]);
+		vector * ws = &watches[falsified];
+		size_t j = 0;
+
+		for (size_t i = 0; i < ws->len; i++) {
+			int c = ws->items[i];
+			if (c_deleted(c)) continue;
+
+			// the falsified watch goes to the second place
+			int * lits = c_lits(c);
+			if (code(lits[0]) == falsified) {
+				int t = lits[0]; lits[0] = lits[1]; lits[1] = t;
+			}
+
+			if (vals[code(lits[0])]) {
+				ws->items[j++] = c;
+				continue;
+			}
+
+			int k;
+			for (k = 2; k < c_size(c); k++)
+				if (!vals[neg(code(lits[k]))]) break;
+
+			if (k < c_size(c)) {
+				int t = lits[1]; lits[1] = lits[k]; lits[k] = t;
+				push(&watches[code(lits[1])], c);
+				continue;
+			}
+
+			ws->items[j++] = c;
+			if (!assign(code(lits[0]))) {
+				while (++i < ws->len) ws->items[j++] = ws->items[i];
+				ws->len = j;
+				return 1;
+			}
+		}
+		ws->len = j;
+	}
+
+	return 0;
+}
+
+/* Reverse unit propagation: assigning the negation of the lemma
+ * along with the units, propagation has to end up in a conflict.
+ */
+int is_rup(const int * lits, int n)
+{
+	int conflict = 0;
+	size_t j = 0;
+
+	for (size_t i = 0; i < units.len; i++) {
+		int c = units.items[i];
+		if (c_deleted(c)) continue;
+		units.items[j++] = c;
+		conflict = conflict || !assign(code(c_lits(c)[0]));
+	}
+	units.len = j;
+
+	for (int i = 0; i < n && !conflict; i++)
+		conflict = !assign(neg(code(lits[i])));
+
+	if (!conflict) conflict = propagate();
+
+	unassign_all();
+	return conflict;
+}
+
+/* Resolution asymmetric tautology on the first literal: every
+ * resolvent with a clause having its negation has to be RUP.
+ */
+int is_rat(const int * lits, int n)
+{
+	if (n == 0) return 0;
+
+	int pivot = lits[0];
+	int * resolvent = malloc((n + n_vars) * 2 * sizeof * resolvent);
+	int ok = 1;
+
+	// deleted clauses are dropped from the occurrences on the way
+	vector * candidates = &occurs[neg(code(pivot))];
+	size_t j = 0;
+	for (size_t k = 0; k < candidates->len; k++) {
+		int c = candidates->items[k];
+		if (c_deleted(c)) continue;
+		candidates->items[j++] = c;
+		if (!ok) continue;
+
+		int * d = c_lits(c);
+
+		int tautology = 0;
+		int m = n;
+		memcpy(resolvent, lits, n * sizeof * lits);
+		for (int i = 0; i < c_size(c); i++) {
+			if (d[i] == -pivot) continue;
+			for (int j = 0; j < n; j++)
+				tautology |= d[i] == -lits[j];
+			resolvent[m++] = d[i];
+		}
+
+		if (!tautology) ok = is_rup(resolvent, m);
+	}
+	candidates->len = j;
+
+	free(resolvent);
+	return ok;
+}
+
+/* ==== Reading ==== */
+// Whole file into a NUL-terminated buffer
+char * read_file(const char * path, size_t * len)
+{
+	FILE * fp = fopen(path, "rb");
+	if (fp == NULL) {
+		perror(path);
+		return NULL;
+	}
+
+	size_t cap = 1 << 16, n;
+	char * buf = malloc(cap);
+	*len = 0;
+	while ((n = fread(buf + *len, 1, cap - *len - 1, fp)) > 0) {
+		*len += n;
+		if (*len + 1 == cap) buf = realloc(buf, cap *= 2);
+	}
+	buf[*len] = '\0';
+
+	fclose(fp);
+	return buf;
+}
+
+// Parses the next integer in text, skipping comment lines
+char * next_int(char * pos, int * x)
+{
+	for (;;) {
+		while (isspace((unsigned char) *pos)) pos++;
+		if (*pos != 'c') break;
+		while (*pos && *pos != '\n') pos++;
+	}
+
+	char * end;
+	long l = strtol(pos, &end, 10);
+	if (end == pos) return NULL;
+
+	*x = (int) l;
+	return end;
+}
+
+int read_formula(const char * path)
+{
+	size_t len;
+	char * text = read_file(path, &len);
+	if (text == NULL) return 0;
+
+	char * pos = text;
+	for (;;) {
+		while (isspace((unsigned char) *pos)) pos++;
+		if (*pos != 'c') break;
+		while (*pos && *pos != '\n') pos++;
+	}
+	if (sscanf(pos, "p cnf %d %d", &n_vars, &n_clauses) != 2) {
+		fputs("Error at the spec line.\n", stderr);
+		free(text);
+		return 0;
+	}
+	while (*pos && *pos != '\n') pos++;
+
+	arena_cap = 4 * (size_t) n_clauses + 16;
+	arena = malloc(arena_cap * sizeof * arena);
+	watches = calloc(2 * n_vars + 2, sizeof * watches);
+	occurs = calloc(2 * n_vars + 2, sizeof * occurs);
+	n_buckets = 2 * (size_t) n_clauses + 1;
+	buckets = calloc(n_buckets, sizeof * buckets);
+	vals = calloc(2 * n_vars + 2, sizeof * vals);
+
+	vector clause = { 0 };
+	int lit, read = 0;
+	while (read < n_clauses && (pos = next_int(pos, &lit)) != NULL) {
+		if (abs(lit) > n_vars) {
+			fprintf(stderr, "Variable %d is out of range.\n", abs(lit));
+			free(text);
+			return 0;
+		}
+		if (lit != 0) {
+			push(&clause, lit);
+			continue;
+		}
+		add_clause(clause.items, normalize(clause.items, clause.len));
+		clause.len = 0;
+		read++;
+	}
+
+	free(clause.items);
+	free(text);
+
+	if (read != n_clauses) {
+		fprintf(stderr, "%d/%d clauses are missing.\n", n_clauses - read, n_clauses);
+		return 0;
+	}
+
+	return 1;
+}
+
+// Binary proofs start with 'a' or 'd', followed by non-text bytes
+int is_binary(const unsigned char * buf, size_t len)
+{
+	for (size_t i = 0; i < len && i < BUFFERSIZE; i++) {
+		unsigned char c = buf[i];
+		if (c != 'a' && c != 'd' && c != 'c' && c != '-' && !isspace(c) && !isdigit(c))
+			return 1;
+	}
+	return 0;
+}
+
+/* Reads the next line of the proof into lemma, telling whether
+ * it is an addition 'a' or a deletion 'd', or 0 at the end.
+ */
+char next_lemma(char ** pos, const char * end, int binary, vector * lemma)
+{
+	lemma->len = 0;
+
+	if (binary) {
+		unsigned char * p = (unsigned char *) *pos;
+		if ((char *) p >= end) return 0;
+
+		char kind = *p++;
+		for (;;) {
+			unsigned int u = 0;
+			int shift = 0;
+			if ((char *) p >= end) return 0;
+			while (*p & 128) {
+				u |= (unsigned int) (*p++ & 127) << shift;
+				shift += 7;
+			}
+			u |= (unsigned int) *p++ << shift;
+			if (u == 0) break;
+			push(lemma, (u & 1) ? -(int) (u >> 1) : (int) (u >> 1));
+		}
+
+		*pos = (char *) p;
+		return (kind == 'a' || kind == 'd') ? kind : 0;
+	}
+
+	char * p = *pos;
+	for (;;) {
+		while (isspace((unsigned char) *p)) p++;
+		if (*p != 'c') break;
+		while (*p && *p != '\n') p++;
+	}
+	if (*p == '\0') return 0;
+
+	char kind = 'a';
+	if (*p == 'd') {
+		kind = 'd';
+		p++;
+	}
+
+	int lit;
+	while ((p = next_int(p, &lit)) != NULL && lit != 0)
+		push(lemma, lit);
+	if (p == NULL) return 0;
+
+	*pos = p;
+	return kind;
+}
+
+int main(int argc, char const *argv[])
+{
+	if (argc != 3) {
+		fprintf(stderr, "Usage: %s problem.cnf proof.drat\n", argv[0]);
+		return -1;
+	}
+
+	if (!read_formula(argv[1])) {
+		fputs("Formula couldn't be read\n", stderr);
+		return -1;
+	}
+
+	size_t len;
+	char * proof = read_file(argv[2], &len);
+	if (proof == NULL) return -1;
+
+	int binary = is_binary((unsigned char *) proof, len);
+	char * pos = proof;
+	vector lemma = { 0 };
+	char kind;
+	long n_lemmas = 0, n_rat = 0;
+	int verified = 0;
+
+	while (!verified && (kind = next_lemma(&pos, proof + len, binary, &lemma)) != 0) {
+		int n = normalize(lemma.items, lemma.len);
+
+		if (kind == 'd') {
+			if (!delete_clause(lemma.items, n))
+				printf("c ignoring deletion of a missing clause\n");
+			continue;
+		}
+
+		n_lemmas++;
+		if (!is_rup(lemma.items, n)) {
+			if (!is_rat(lemma.items, n)) {
+				printf("c lemma #%ld is neither RUP nor RAT:", n_lemmas);
+				for (int i = 0; i < n; i++) printf(" %d", lemma.items[i]);
+				printf(" 0\ns NOT VERIFIED\n");
+				return 1;
+			}
+			n_rat++;
+		}
+
+		if (n == 0) verified = 1;
+		else add_clause(lemma.items, n);
+	}
+
+	printf("c %ld lemmas checked, %ld of them RAT\n", n_lemmas, n_rat);
+	if (!verified) {
+		printf("c no empty clause in the proof\ns NOT VERIFIED\n");
+		return 1;
+	}
+
+	printf("s VERIFIED\n");
+	return 0;
+}
@@ -1,34 +1,31 @@
 //  Byron Boots (based on Stephen Majercik's code)
+//  Reworked to have no limits on the size of formulas.
 
-//  Compile with:  gcc verify.c -o verify
+//  Compile with:  gcc -O2 verify.c -o verify
 
 // Includes
 #include <stdio.h>
-#include <string.h>
-#include <ctype.h>
-#include <math.h>
 #include <stdlib.h>
+#include <ctype.h>
 #include <stdbool.h>
 
-//  Defines
-#define LPC  100     		// Max literals per clause. 
-#define VARS 10000	        // Max variables (minus 1). 
-#define EC   500000	        // Max Total clauses. 
-#define MAX_LINE_CHARS 500      //
-
-// Command line arguments 
-char *SATfilename;     
+// Command line arguments
+char *SATfilename;
 char *SOLUTIONfilename;
 
-// Other global variables 
-int vars = 0;		       // number of variables. 
-int clauses = 0;             // number of clauses. 
-int form[EC][LPC];	       // the formula... which vars in which clauses. 
-int sgn[EC][LPC];	       // sign of variable (0 = negated, 1 = not negated)
-int lic[EC];		       // number of literals in clause
-int assgn[VARS];	       // holds current truth assignment
+// Other global variables
+int vars = 0;                // number of variables.
+int clauses = 0;             // number of clauses.
+int *lits;                   // literals of all clauses one after another,
+                             // each clause terminated with a 0
+size_t n_lits = 0;           // length of lits
+size_t cap_lits = 0;         // capacity of lits
+char *assgn;                 // holds current truth assignment, 1-indexed
 
 // functions
+char *read_file(FILE *infile);
+char *skip_line(char *pos);
+char *read_int(char *pos, int *x);
 void read_formula(FILE *SATfile);
 void read_solution(FILE *SOLUTIONfile);
 bool check_solution();
@@ -52,14 +49,14 @@ int main(int argc, char *argv[]) {
     fprintf(stderr, "error opening \'%s\'\n", SATfilename);
     exit(-1);
   }
-  
+
   SOLUTIONfilename = argv[2];
   FILE *SOLUTIONfile;
   if ((SOLUTIONfile = fopen(SOLUTIONfilename, "r")) == NULL) {
     fprintf(stderr, "error opening \'%s\'\n", SOLUTIONfilename);
     exit(-1);
   }
-  
+
   // read the formula and solution files
   read_formula(SATfile);
   read_solution(SOLUTIONfile);
@@ -70,140 +67,191 @@ int main(int argc, char *argv[]) {
     printf("Assignment is satisfying!\n");
 
   printf("\n");
+  free(lits);
+  free(assgn);
 return 0;
 }
 
 
 
+// reads the whole file into a NUL-terminated buffer,
+// so that it can be parsed without a call per token
+char *read_file(FILE *infile) {
 
-void read_formula(FILE *infile) {
+  size_t len = 0, cap = 1 << 16, n;
+  char *buf = malloc(cap);
 
-  // read a line at a time
-  char line_string[MAX_LINE_CHARS+1];
-  char *pos_line_string;
-
-  fgets(line_string, MAX_LINE_CHARS, infile);
-  while (line_string[0] == 'c') 
-    fgets(line_string, MAX_LINE_CHARS, infile);
-
-  pos_line_string = line_string;
-  // go past the 'p'
-  pos_line_string = strchr(pos_line_string, ' ') + 1;
-  // go past the 'cnf'
-  pos_line_string = strchr(pos_line_string, ' ') + 1;
-  // get the number of variables and clauses
-  sscanf(pos_line_string, "%d %d", &vars, &clauses);
-
-  // error if too many variables in SAT formula
-  if (vars >= VARS) {
-    fprintf(stderr, "Variable %d does not fit within ", vars);
-    fprintf(stderr, "the limit of %d vars.\n", VARS-1);
-    exit(-1);
+  while (buf != NULL && (n = fread(buf + len, 1, cap - len - 1, infile)) > 0) {
+    len += n;
+    if (len + 1 == cap)
+      buf = realloc(buf, cap *= 2);
   }
 
-  // error if too many clauses in SAT formula
-  if (clauses >= EC) {
-    fprintf(stderr, "Too many clauses, should be at most %d\n", EC);
+  if (buf == NULL) {
+    fprintf(stderr, "out of memory reading input\n");
     exit(-1);
   }
 
-  int lit;    	     // current literal read
-  int litnum;	     // number of literals in clause 
-  int c;
-  for (c = 0 ; c < clauses ; c++) {
-
-    fgets(line_string, MAX_LINE_CHARS, infile);
-    pos_line_string = line_string;
-    sscanf(pos_line_string, "%d", &lit);
-
-    // start reading literals in clause
-    litnum = 0;
-    do {
-
-      if (lit < 0) {   // literal is negated
-	form[c][litnum] = -lit;
-	sgn[c][litnum] = 0;
-      }
-      else {           // literal is not negated
-	form[c][litnum] = lit;
-	sgn[c][litnum] = 1;
-      }
-      
-      // keep track of number of literals in clause
-      litnum++;
-
-      // error if too many literals in clause
-      if (litnum >= LPC) {
-	fprintf(stderr, "Two many literals in clause %d, ", c);
-	fprintf(stderr, "should be at most %d\n", LPC);
-	exit(-1);
-      }
-
-      pos_line_string = strchr(pos_line_string, ' ') + 1;
-      sscanf(pos_line_string, "%d", &lit);
-
-    } while (lit != 0);
-
-    // store number of literals in clause
-    lic[c] = litnum;
+  buf[len] = '\0';
+  fclose(infile);
+  return buf;
+}
+
+char *skip_line(char *pos) {
+
+  while (*pos != '\0' && *pos != '\n')
+    pos++;
+  return pos;
+}
+
+// parses a decimal integer after any whitespace, NULL if there is none
+char *read_int(char *pos, int *x) {
+
+  while (isspace((unsigned char) *pos))
+    pos++;
 
+  int sign = 1;
+  if (*pos == '-') {
+    sign = -1;
+    pos++;
   }
-  
+
+  if (!isdigit((unsigned char) *pos))
+    return NULL;
+
+  int value = 0;
+  while (isdigit((unsigned char) *pos))
+    value = value * 10 + (*pos++ - '0');
+
+  *x = sign * value;
+  return pos;
 }
 
 
 
+void read_formula(FILE *infile) {
+
+  char *text = read_file(infile);
+  char *pos = text;
+
+  // skip the comments up to the spec line
+  while (*pos == 'c' || *pos == '\n')
+    pos = skip_line(pos) + (*skip_line(pos) == '\n');
+
+  if (sscanf(pos, "p cnf %d %d", &vars, &clauses) != 2) {
+    fprintf(stderr, "missing the spec line\n");
+    exit(-1);
+  }
+  pos = skip_line(pos);
+
+  cap_lits = (size_t) clauses * 4 + 1;
+  lits = malloc(cap_lits * sizeof *lits);
+
+  // a clause may span many lines, and end with a 0
+  int lit;
+  int c = 0;
+  while (c < clauses) {
 
+    while (isspace((unsigned char) *pos))
+      pos++;
+    if (*pos == 'c') {
+      pos = skip_line(pos);
+      continue;
+    }
+
+    if ((pos = read_int(pos, &lit)) == NULL) {
+      fprintf(stderr, "%d/%d clauses are missing\n", clauses - c, clauses);
+      exit(-1);
+    }
+
+    // error if a variable is out of range of the spec line
+    if (abs(lit) > vars) {
+      fprintf(stderr, "Variable %d does not fit within ", abs(lit));
+      fprintf(stderr, "the %d vars of the spec line.\n", vars);
+      exit(-1);
+    }
+
+    if (n_lits == cap_lits)
+      lits = realloc(lits, (cap_lits *= 2) * sizeof *lits);
+    lits[n_lits++] = lit;
+
+    if (lit == 0)
+      c++;
+  }
+
+  free(text);
+}
+
+
+
+// reads either "var value" lines, or "v lit lit ..." lines
 void read_solution(FILE *infile) {
 
-  char line_string[MAX_LINE_CHARS+1];
+  char *text = read_file(infile);
+  char *pos = text;
+  bool value_lines = false;
+
+  assgn = calloc(vars + 1, sizeof *assgn);
+
+  while (*pos != '\0') {
+
+    if (*pos == 'c' || *pos == 's') {
+      pos = skip_line(pos);
+      continue;
+    }
+    if (*pos == 'v')
+      value_lines = true;
+    if (*pos == 'v' || isspace((unsigned char) *pos)) {
+      pos++;
+      continue;
+    }
 
-  fgets(line_string, MAX_LINE_CHARS, infile);
-  while (line_string[0] == 'c') 
-    fgets(line_string, MAX_LINE_CHARS, infile);
-  int v;
-  for (v = 1 ; v <= vars ; v++) {
     int var, value;
-    sscanf(line_string, "%d  %d", &var, &value);
-    assgn[var] = value;
+    if ((pos = read_int(pos, &var)) == NULL)
+      break;
+
+    if (value_lines) {
+      value = var > 0;
+      var = abs(var);
+    }
+    else if ((pos = read_int(pos, &value)) == NULL)
+      break;
 
-    fgets(line_string, MAX_LINE_CHARS, infile);
+    if (var >= 1 && var <= vars)
+      assgn[var] = value != 0;
   }
 
+  free(text);
 }
 
+// a single pass over all the literals, reporting each unsatisfied clause
 bool check_solution() {
 
   bool retval = true;
-  int c;
-  for (c = 0; c < clauses; c++) {
-    int satlits = 0;
-	int l;
-    for (l = 0; l < lic[c]; l++) {
-      if (assgn[form[c][l]] == sgn[c][l]) {
-	++satlits;
-	break;
-      }
+  bool satisfied = false;
+  size_t start = 0;
+  int c = 0;
+
+  for (size_t l = 0; l < n_lits; l++) {
+
+    int lit = lits[l];
+    if (lit != 0) {
+      satisfied = satisfied || assgn[abs(lit)] == (lit > 0);
+      continue;
     }
-    
-    if (satlits == 0) {
+
+    if (!satisfied) {
       printf("Clause %d  (", c+1);
-      if (sgn[c][0] == 0)
-	printf("%d", -form[c][0]);
-      else
-	printf("%d", form[c][0]);
-	 int l;
-      for (l = 1; l < lic[c]; l++) {
-	if (sgn[c][l] == 0)
-	  printf(" %d", -form[c][l]);
-	else
-	  printf(" %d", form[c][l]);
-      }
+      for (size_t k = start; k < l; k++)
+        printf(k == start ? "%d" : " %d", lits[k]);
       printf(")  is not satisfied!\n");
       retval = false;
     }
+
+    satisfied = false;
+    start = l + 1;
+    c++;
   }
 
   return retval;
 }
-
@@ -0,0 +1,231 @@
+/* IPASIR interface of the sat3 library.
+ *
+ * Clauses are added to the formula one literal at a time, and
+ * every call to ipasir_solve searches depth-first from a root
+ * with the assumptions applied. There are no learned clauses
+ * to carry over, what carries over from one call to the next is:
+ *   - the bitmaps of the formula, only ever growing
+ *   - the formula being unsatisfiable on its own, for good
+ *   - the last model, returned at once while it still holds
+ *   - the clauses vivified at the top level, every time they
+ *     have doubled since the last time
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "sat3.h"
+#include "ipasir.h"
+
+#define VIVIFY_BUDGET 10000000	// clauses checked by each vivification
+#define VIVIFY_MIN 100			// clauses before the first one
+
+typedef
+struct ipasir_solver_tag {
+	formula * f;
+	solver s;
+
+	int * clause;			// clause being added, until its 0
+	size_t clause_len;
+	size_t clause_cap;
+
+	int * assumptions;		// for the next call to solve
+	size_t n_assumptions;
+	size_t assumptions_cap;
+	int * failed;			// assumptions of the last call
+	size_t n_failed;
+	size_t failed_cap;
+
+	int result;				// of the last call, 10, 20 or 0
+	int unsat;				// formula is unsatisfiable without assumptions
+	unsigned int vivified;	// clauses after the last vivification
+	signed char * model;	// 1 or -1 for each variable, from the last model
+	size_t model_len;		// variables in it, plus one
+} ipasir_solver;
+
+/* ==== Helper Functions ==== */
+int * push_lit(int * lits, size_t * len, size_t * cap, int lit)
+{
+	if (*len == *cap) {
+		*cap = *cap ? 2 * *cap : 16;
+		lits = realloc(lits, *cap * sizeof * lits);
+	}
+	lits[(*len)++] = lit;
+	return lits;
+}
+
+int model_value(ipasir_solver * is, int lit)
+{
+	size_t var = abs(lit);
+	int value = (var < is->model_len) ? is->model[var] : -1;
+	return (lit > 0) ? value : -value;
+}
+
+/* Tells whether the last model satisfies the clauses and the
+ * assumptions, variables new since then taken as false.
+ */
+int model_holds(ipasir_solver * is)
+{
+	const formula * f = is->f;
+	int satisfied = 0;
+
+	if (is->model == NULL) return 0;
+
+	for (size_t i = 0; i < is->n_assumptions; i++)
+		if (model_value(is, is->assumptions[i]) < 0)
+			return 0;
+
+	for (size_t i = 0; i < f->lits_len; i++) {
+		if (f->lits[i] == 0) {
+			if (!satisfied) return 0;
+			satisfied = 0;
+		}
+		else if (!satisfied)
+			satisfied = model_value(is, f->lits[i]) > 0;
+	}
+
+	return 1;
+}
+
+void model_store(ipasir_solver * is, bitstore * config)
+{
+	const formula * f = is->f;
+
+	is->model_len = f->n_vars + 1;
+	is->model = realloc(is->model, is->model_len);
+	for (int i = 1; i <= f->n_vars; i++)
+		is->model[i] = var_value(f, config, i) ? 1 : -1;
+}
+
+// Variables new since the model was found are fixed to be false
+void model_extend(ipasir_solver * is)
+{
+	size_t len = is->f->n_vars + 1;
+	if (len <= is->model_len) return;
+
+	is->model = realloc(is->model, len);
+	memset(is->model + is->model_len, -1, len - is->model_len);
+	is->model_len = len;
+}
+
+/* ==== IPASIR Functions ==== */
+const char * ipasir_signature(void)
+{
+	return "sat3 DPLL on bitmaps";
+}
+
+void * ipasir_init(void)
+{
+	ipasir_solver * is = calloc(1, sizeof * is);
+	is->f = formula_new();
+	solver_init(&is->s, is->f);
+	is->s.depth_first = 1;
+	return is;
+}
+
+void ipasir_release(void * solver)
+{
+	ipasir_solver * is = solver;
+
+	solver_clean(&is->s);
+	formula_free(is->f);
+	free(is->clause);
+	free(is->assumptions);
+	free(is->failed);
+	free(is->model);
+	free(is);
+}
+
+void ipasir_add(void * solver, int lit_or_zero)
+{
+	ipasir_solver * is = solver;
+
+	if (lit_or_zero != 0) {
+		is->clause = push_lit(is->clause, &is->clause_len, &is->clause_cap, lit_or_zero);
+		return;
+	}
+
+	formula_add_clause(is->f, is->clause, is->clause_len);
+	is->clause_len = 0;
+}
+
+void ipasir_assume(void * solver, int lit)
+{
+	ipasir_solver * is = solver;
+	is->assumptions = push_lit(is->assumptions, &is->n_assumptions, &is->assumptions_cap, lit);
+}
+
+int ipasir_solve(void * solver)
+{
+	ipasir_solver * is = solver;
+	bitstore * config = NULL;
+	dpll_result result;
+
+	for (size_t i = 0; i < is->n_assumptions; i++)
+		formula_add_vars(is->f, abs(is->assumptions[i]));
+
+	if (is->unsat)
+		result = FAIL;
+	else if (model_holds(is)) {
+		model_extend(is);
+		result = SUCCESS;
+	}
+	else {
+		if (is->f->n_clauses >= 2 * is->vivified + VIVIFY_MIN) {
+			unsigned int deleted;
+			formula_vivify(is->f, VIVIFY_BUDGET, NULL, &deleted);
+			is->vivified = is->f->n_clauses;
+		}
+		result = solver_solve(&is->s, is->assumptions, is->n_assumptions, &config);
+		if (result == SUCCESS)
+			model_store(is, config);
+		if (result == FAIL && is->n_assumptions == 0)
+			is->unsat = 1;
+		free(config);
+	}
+
+	// assumptions hold for a single call, and are all blamed if UNSAT
+	if (is->n_assumptions > is->failed_cap) {
+		is->failed_cap = is->assumptions_cap;
+		is->failed = realloc(is->failed, is->failed_cap * sizeof * is->failed);
+	}
+	if (is->n_assumptions > 0)
+		memcpy(is->failed, is->assumptions, is->n_assumptions * sizeof * is->failed);
+	is->n_failed = is->n_assumptions;
+	is->n_assumptions = 0;
+
+	switch (result) {
+		case SUCCESS: return is->result = 10;
+		case FAIL:    return is->result = 20;
+		default:      return is->result = 0;
+	}
+}
+
+int ipasir_val(void * solver, int lit)
+{
+	ipasir_solver * is = solver;
+	return (model_value(is, lit) > 0) ? lit : -lit;
+}
+
+// The assumptions are not analyzed, every one of them takes part in the conflict
+int ipasir_failed(void * solver, int lit)
+{
+	ipasir_solver * is = solver;
+
+	if (is->result != 20 || is->unsat) return 0;
+	for (size_t i = 0; i < is->n_failed; i++)
+		if (is->failed[i] == lit)
+			return 1;
+	return 0;
+}
+
+void ipasir_set_terminate(void * solver, void * data, int (* terminate)(void * data))
+{
+	ipasir_solver * is = solver;
+	is->s.terminate = terminate;
+	is->s.terminate_data = data;
+}
+
+// Nothing is ever learned, so there is nothing to hand over
+void ipasir_set_learn(void * solver, void * data, int max_length, void (* learn)(void * data, int * clause))
+{
+}
@@ -0,0 +1,26 @@
+/* The re-entrant incremental SAT solver API of the SAT Race,
+ * as in https://github.com/biotomas/ipasir
+ */
+#ifndef IPASIR_H
+#define IPASIR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const char * ipasir_signature(void);
+void * ipasir_init(void);
+void ipasir_release(void * solver);
+void ipasir_add(void * solver, int lit_or_zero);
+void ipasir_assume(void * solver, int lit);
+int ipasir_solve(void * solver);
+int ipasir_val(void * solver, int lit);
+int ipasir_failed(void * solver, int lit);
+void ipasir_set_terminate(void * solver, void * data, int (* terminate)(void * data));
+void ipasir_set_learn(void * solver, void * data, int max_length, void (* learn)(void * data, int * clause));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,5067 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include "sat3.h"
+
+// Uncomment the following for debug messages
+// #define DEBUG
+
+// Uncomment the following, or define it, for profiling timers
+// #define PROFILE
+
+#if defined(PROFILE) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+#define BUFFERSIZE 1024
+#define EXPLPC 4
+
+typedef
+struct pair_tag {
+	int a, b;
+} pair;
+
+/* ==== Function for Rounding Positive Doubles ==== */
+// This is to avoid complications of including math.h on Linux
+int round_pos(double d)
+{
+	return d + 0.5;
+}
+
+/* ==== Function for Formatting Integers ==== */
+// Writes x in decimal, returning past its last digit
+char * put_int(char * buf, int x)
+{
+	char digits[12];
+	int n = 0;
+	unsigned int u = (x < 0) ? -(unsigned int) x : (unsigned int) x;
+
+	if (x < 0) *buf++ = '-';
+	do digits[n++] = '0' + u % 10;
+	while (u /= 10);
+	while (n) *buf++ = digits[--n];
+
+	return buf;
+}
+
+/* ==== Functions for Timing ==== */
+double ts_to_sec(struct timespec t)
+{
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+double monotonic_sec(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return ts_to_sec(t);
+}
+
+/* ==== Statistics Functions ==== */
+/* Counters and timers of the search beyond decisions and
+ * conflicts, which are updated through the macros below,
+ * so that they compile to nothing without STATS.
+ * Phases are timed around whole calls, as a clock read
+ * costs less than a reduction step by orders of magnitude.
+ */
+const char * phase_names[N_PHASES] = { "Parse", "Reduce", "Choose", "Search" };
+
+#ifdef STATS
+#define stat_inc(s, x)     ((s)->stats.x++)
+#define stat_set(s, x, v)  do { (s)->stats.x = (v); if ((s)->stats.x > (s)->stats.peak_##x) (s)->stats.peak_##x = (s)->stats.x; } while (0)
+#define phase_begin(p)     double p##_start = monotonic_sec()
+#define phase_end(s, p)    ((s)->stats.phase_time[p] += monotonic_sec() - p##_start)
+#else
+#define stat_inc(s, x)     ((void) 0)
+#define stat_set(s, x, v)  ((void) 0)
+#define phase_begin(p)     ((void) 0)
+#define phase_end(s, p)    ((void) 0)
+#endif
+
+/* A comment line with the counters so far, every
+ * progress_interval seconds, polled by the searchers.
+ */
+void stats_progress(solver * s)
+{
+#ifdef STATS
+	if (s->stats.progress_interval == 0) return;
+
+	double now = monotonic_sec();
+	if (now - s->stats.progress_last < s->stats.progress_interval) return;
+	s->stats.progress_last = now;
+
+	if (s->sls != SLS_NONE)
+		printf("c %10.2fs  flips %llu  unsatisfied %zu\n",
+			now - s->search_start, s->n_flips, s->stats.frontier);
+	else
+		printf("c %10.2fs  decisions %llu  conflicts %llu  propagations %llu  frontier %zu\n",
+			now - s->search_start,
+			s->n_decisions, s->n_conflicts, s->stats.propagations, s->stats.frontier);
+	fflush(stdout);
+#endif
+}
+
+void stats_print(const solver * s, const char * prefix)
+{
+	printf("%sDecisions: %llu\n", prefix, s->n_decisions);
+#ifdef STATS
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	printf("%sPropagations: %llu\n", prefix, s->stats.propagations);
+#endif
+	printf("%sConflicts: %llu\n", prefix, s->n_conflicts);
+	if (s->sls != SLS_NONE)
+		printf("%sFlips: %llu\n", prefix, s->n_flips);
+#ifdef STATS
+	printf("%sPure literals: %llu\n", prefix, s->stats.pure_literals);
+	printf("%sConsolidations: %llu\n", prefix, s->stats.consolidations);
+	printf("%sPeak frontier: %zu\n", prefix, s->stats.peak_frontier);
+	if (s->stats.components) {
+		printf("%sComponents: %llu\n", prefix, s->stats.components);
+		printf("%sCache hits: %llu\n", prefix, s->stats.cache_hits);
+	}
+	if (s->stats.xors)
+		printf("%sXORs: %u, implying %llu literals\n", prefix, s->stats.xors, s->stats.xor_units);
+	if (s->f->n_cards)
+		printf("%sCardinality constraints: %u, implying %llu literals\n", prefix, s->f->n_cards, s->stats.card_units);
+	if (s->stats.backjumps)
+		printf("%sBackjumps: %llu over %llu levels\n", prefix, s->stats.backjumps, s->stats.jumped_levels);
+	if (s->stats.splits)
+		printf("%sSplits: %llu into %llu components\n", prefix, s->stats.splits, s->stats.split_components);
+	for (int p = 0; p < N_PHASES; p++)
+		printf("%s%s time: %fs\n", prefix, phase_names[p], s->stats.phase_time[p]);
+	printf("%sPeak memory: %ld KiB\n", prefix, usage.ru_maxrss);
+#endif
+}
+
+/* ==== Profiling Functions ==== */
+/* Scoped timers around the kernels of the search, for when
+ * gprof is too coarse for them. A timer is started by
+ * prof_scope at the top of a block, and stopped by the
+ * compiler when the block is left, whichever way it is.
+ * Time is read from the TSC where there is one, and from
+ * CLOCK_MONOTONIC_RAW elsewhere, in ticks calibrated at
+ * the start. Timed scopes and the decisions and conflicts
+ * of the search can also be traced in the Chrome trace
+ * event format, to be opened in chrome://tracing or Perfetto.
+ * All of it compiles to nothing without PROFILE. Timers are
+ * for the whole process, meant for profiling a single search.
+ */
+typedef
+enum prof_timer_tag {
+	PROF_C_LEN,		// c_len_reductions
+	PROF_PURITY,	// purity_reduction
+	PROF_CHOOSE,	// lit_choose_max_occur_power
+	PROF_COPY,		// copies of configurations
+	N_PROF
+} prof_timer;
+
+#define TRACE_MAX_EVENTS (1 << 22)	// about 400 MB of JSON, beyond which viewers choke
+
+#ifdef PROFILE
+typedef
+struct prof_frame_tag {
+	prof_timer timer;
+	uint64_t start;
+} prof_frame;
+
+const char * prof_names[N_PROF] = {
+	"c_len_reductions", "purity_reduction", "lit_choose_max_occur_power", "copy_config"
+};
+
+uint64_t prof_calls[N_PROF];
+uint64_t prof_total[N_PROF];		// ticks
+uint64_t prof_origin;				// ticks at prof_init
+double prof_tick_sec = 1e-9;		// seconds per tick
+FILE * trace = NULL;
+uint64_t trace_events;
+
+uint64_t prof_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+	return t.tv_sec * 1000000000ULL + t.tv_nsec;
+#endif
+}
+
+double raw_sec(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+	return ts_to_sec(t);
+}
+
+// Measures the ticks against the raw clock for 20 ms
+void prof_init(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	double start = raw_sec(), now;
+	uint64_t ticks = prof_ticks();
+	while ((now = raw_sec()) - start < 0.02);
+	prof_tick_sec = (now - start) / (prof_ticks() - ticks);
+#endif
+	prof_origin = prof_ticks();
+}
+
+double prof_us(uint64_t ticks)
+{
+	return ticks * prof_tick_sec * 1e6;
+}
+
+int trace_open(const char * path)
+{
+	if ((trace = fopen(path, "w")) == NULL) {
+		perror("Error opening trace file to write.");
+		return 0;
+	}
+	setvbuf(trace, NULL, _IOFBF, 1 << 20);
+	fputs("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n", trace);
+	fputs("{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"satsolver3\"}}", trace);
+	return 1;
+}
+
+void trace_close(void)
+{
+	fputs("\n]}\n", trace);
+	if (ferror(trace) | fclose(trace))
+		perror("Error writing trace.");
+	trace = NULL;
+}
+
+// A complete event of a timed scope, or an instant one with a literal
+void trace_event(const char * name, uint64_t start, uint64_t end, int lit)
+{
+	if (trace_events++ >= TRACE_MAX_EVENTS) return;
+
+	if (end == 0)
+		fprintf(trace, ",\n{\"name\": \"%s\", \"ph\": \"i\", \"s\": \"t\", \"ts\": %.3f, "
+			"\"pid\": 1, \"tid\": 1, \"args\": {\"lit\": %d}}",
+			name, prof_us(start - prof_origin), lit);
+	else
+		fprintf(trace, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+			"\"pid\": 1, \"tid\": 1}",
+			name, prof_us(start - prof_origin), prof_us(end - start));
+}
+
+prof_frame prof_enter(prof_timer timer)
+{
+	prof_frame frame = { timer, prof_ticks() };
+	return frame;
+}
+
+void prof_leave(prof_frame * frame)
+{
+	uint64_t end = prof_ticks();
+	prof_calls[frame->timer]++;
+	prof_total[frame->timer] += end - frame->start;
+	if (trace != NULL)
+		trace_event(prof_names[frame->timer], frame->start, end, 0);
+}
+
+void prof_print(const char * prefix)
+{
+	for (int t = 0; t < N_PROF; t++)
+		printf("%s%-28s %12llu calls %12.3f ms %10.1f ns/call\n", prefix,
+			prof_names[t], (unsigned long long) prof_calls[t],
+			prof_total[t] * prof_tick_sec * 1e3,
+			prof_calls[t] ? prof_total[t] * prof_tick_sec * 1e9 / prof_calls[t] : 0.0);
+	if (trace_events > TRACE_MAX_EVENTS)
+		printf("%sTrace is cut at %d of %llu events\n", prefix,
+			TRACE_MAX_EVENTS, (unsigned long long) trace_events);
+}
+
+#define prof_scope(t)      prof_frame prof_scope_frame __attribute__((cleanup(prof_leave))) = prof_enter(t)
+#define prof_mark(name, l) do { if (trace != NULL) trace_event(name, prof_ticks(), 0, l); } while (0)
+#else
+#define prof_scope(t)      ((void) 0)
+#define prof_mark(name, l) ((void) 0)
+#endif
+
+/* ==== Bit-operation Functions ==== */
+// https://stackoverflow.com/a/109025/2736228
+#if BITSTORE_BITS == 64
+int count_bits(bitstore i)
+{
+	i = i - ((i >> 1) & 0x5555555555555555);
+	i = (i & 0x3333333333333333) + ((i >> 2) & 0x3333333333333333);
+	return (((i + (i >> 4)) & 0x0F0F0F0F0F0F0F0F) * 0x0101010101010101) >> 56;
+}
+#else
+int count_bits(bitstore i)
+{
+	i = i - ((i >> 1) & 0x55555555);
+	i = (i & 0x33333333) + ((i >> 2) & 0x33333333);
+	return (((i + (i >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+}
+#endif
+
+// https://stackoverflow.com/a/757266/2736228
+#if BITSTORE_BITS == 64
+uint8_t least_bit_pos(bitstore v)
+{
+	static const uint8_t debruijnbitposition2[64] = {
+		0, 1, 2, 53, 3, 7, 54, 27, 4, 38, 41, 8, 34, 55, 48, 28,
+		62, 5, 39, 46, 44, 42, 22, 9, 24, 35, 59, 56, 49, 18, 29, 11,
+		63, 52, 6, 26, 37, 40, 33, 47, 61, 45, 43, 21, 23, 58, 17, 10,
+		51, 25, 36, 32, 60, 20, 57, 16, 50, 31, 19, 15, 30, 14, 13, 12
+	};
+	return debruijnbitposition2[((v & (-v)) * 0x022fdd63cc95386dULL) >> 58];
+}
+#else
+uint8_t least_bit_pos(bitstore v)
+{
+	static const uint8_t debruijnbitposition2[32] = {
+		0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+		31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+	};
+	return debruijnbitposition2[((uint32_t)((v & (-v)) * 0x077cb531u)) >> 27];
+}
+#endif
+
+int int_cmp(const void * a, const void * b)
+{
+	return (*(const int *) a > *(const int *) b) - (*(const int *) a < *(const int *) b);
+}
+
+// Finalizer of splitmix64, spreading the bits of x all over
+uint64_t mix64(uint64_t x)
+{
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/* ==== Initialization and Clean-up Functions ==== */
+/* Formulas grow as clauses are added, read or not, so the
+ * bitmaps are kept with room to spare: rows of clauses and
+ * variables, and words in each row, are doubled whenever
+ * they run out, for adding a clause to cost amortized time.
+ */
+void formula_sizes(formula * f)
+{
+	f->cconf_len = f->n_clauses / sbitstore + 1;
+	f->olconf_len = f->n_vars / sbitstore + 1;
+	f->cfg_len = f->cconf_len + 2 * f->olconf_len;
+	f->cfg_size = f->cfg_len * sizeof(bitstore);
+	f->mean_occ_len = f->n_vars ? (double) f->n_lits / f->n_vars : 0;
+}
+
+formula * formula_new(void)
+{
+	formula * f = calloc(1, sizeof * f);
+
+	f->clauses = calloc(1, sizeof * f->clauses);
+	f->occurlists = calloc(1, sizeof * f->occurlists);
+	f->clause_offs = malloc(sizeof * f->clause_offs);
+
+	f->lits_cap = 1024;
+	f->lits = malloc(f->lits_cap * sizeof * f->lits);
+
+	formula_sizes(f);
+	f->clause_words = f->cconf_len;
+	f->var_words = f->olconf_len;
+	return f;
+}
+
+void formula_free(formula * f)
+{
+	for (int i = 1; i <= f->n_clauses; i++) {
+		free(f->clauses[i]);
+		free(f->clauses[-i]);
+	}
+
+	for (int i = 1; i <= f->n_vars; i++) {
+		free(f->occurlists[i]);
+		free(f->occurlists[-i]);
+	}
+
+	free(f->clauses - f->clauses_cap);
+	free(f->occurlists - f->vars_cap);
+
+	free(f->lits);
+	free(f->clause_offs);
+	free(f->cards);
+	free(f->counters);
+	free(f);
+}
+
+// Moves the rows from -n to n into an array indexed from -new_cap to new_cap
+bitstore ** grow_rows(bitstore ** rows, unsigned int n, unsigned int cap, unsigned int new_cap)
+{
+	bitstore ** grown = malloc((2 * (size_t) new_cap + 1) * sizeof * grown);
+	grown += new_cap;
+
+	for (int i = -(int) n; i <= (int) n; i++)
+		grown[i] = rows[i];
+	free(rows - cap);
+
+	return grown;
+}
+
+// Widens the rows from -n to n to new_words, the new ones zeroed
+void widen_rows(bitstore ** rows, unsigned int n, size_t words, size_t new_words)
+{
+	for (int i = -(int) n; i <= (int) n; i++) if (i != 0) {
+		rows[i] = realloc(rows[i], new_words * sizeof * rows[i]);
+		memset(rows[i] + words, 0, (new_words - words) * sizeof * rows[i]);
+	}
+}
+
+// Makes room for the given numbers of variables and clauses
+void formula_reserve(formula * f, unsigned int vars, unsigned int clauses)
+{
+	size_t clause_words = clauses / sbitstore + 1;
+	size_t var_words = vars / sbitstore + 1;
+
+	if (clauses > f->clauses_cap) {
+		unsigned int cap = (clauses > 2 * f->clauses_cap) ? clauses : 2 * f->clauses_cap;
+		f->clauses = grow_rows(f->clauses, f->n_clauses, f->clauses_cap, cap);
+		f->clause_offs = realloc(f->clause_offs, (cap + 1) * sizeof * f->clause_offs);
+		f->clauses_cap = cap;
+	}
+
+	if (vars > f->vars_cap) {
+		unsigned int cap = (vars > 2 * f->vars_cap) ? vars : 2 * f->vars_cap;
+		f->occurlists = grow_rows(f->occurlists, f->n_vars, f->vars_cap, cap);
+		f->vars_cap = cap;
+	}
+
+	if (clause_words > f->clause_words) {
+		size_t words = (clause_words > 2 * f->clause_words) ? clause_words : 2 * f->clause_words;
+		widen_rows(f->occurlists, f->n_vars, f->clause_words, words);
+		f->clause_words = words;
+	}
+
+	if (var_words > f->var_words) {
+		size_t words = (var_words > 2 * f->var_words) ? var_words : 2 * f->var_words;
+		widen_rows(f->clauses, f->n_clauses, f->var_words, words);
+		f->var_words = words;
+	}
+}
+
+void formula_add_vars(formula * f, unsigned int n_vars)
+{
+	if (n_vars <= f->n_vars) return;
+	formula_reserve(f, n_vars, f->n_clauses);
+
+	for (int i = f->n_vars + 1; i <= n_vars; i++) {
+		f->occurlists[i] = calloc(f->clause_words, sizeof * f->occurlists[i]);
+		f->occurlists[-i] = calloc(f->clause_words, sizeof * f->occurlists[-i]);
+	}
+
+	f->n_vars = n_vars;
+	formula_sizes(f);
+}
+
+/* ==== Functions for Reading and Populating Formula ==== */
+// Appends to the flat literal array, 0 for ending a clause
+void lits_push(formula * f, int lit)
+{
+	if (f->lits_len == f->lits_cap) {
+		f->lits_cap *= 2;
+		f->lits = realloc(f->lits, f->lits_cap * sizeof * f->lits);
+	}
+	f->lits[f->lits_len++] = lit;
+}
+
+void lits_add(formula * f, int lit, int i_clause)
+{
+	if (lit > 0) s_set(f->clauses[i_clause], lit);
+	else         s_set(f->clauses[-i_clause], -lit);
+	s_set(f->occurlists[lit], i_clause);
+	lits_push(f, lit);
+	f->n_lits++;
+}
+
+void formula_add_clause(formula * f, const int * lits, size_t n)
+{
+	unsigned int max_var = 0;
+	for (size_t i = 0; i < n; i++)
+		if (abs(lits[i]) > max_var) max_var = abs(lits[i]);
+
+	formula_add_vars(f, max_var);
+	formula_reserve(f, f->n_vars, f->n_clauses + 1);
+
+	int i_clause = ++f->n_clauses;
+	f->clauses[i_clause] = calloc(f->var_words, sizeof * f->clauses[i_clause]);
+	f->clauses[-i_clause] = calloc(f->var_words, sizeof * f->clauses[-i_clause]);
+	f->clause_offs[i_clause] = f->lits_len;
+
+	for (size_t i = 0; i < n; i++)
+		lits_add(f, lits[i], i_clause);
+	lits_push(f, 0);
+
+	formula_sizes(f);
+}
+
+int formula_read(formula * f, FILE * fp)
+{
+	char buffer[BUFFERSIZE];
+	unsigned int n_vars, n_clauses;
+
+	while (fgets(buffer, BUFFERSIZE, fp) != NULL)
+	switch (*buffer) {
+		case 'c': // a comment
+			break;
+		case 'p': // the spec
+			if (sscanf(buffer, "p cnf %u %u", &n_vars, &n_clauses) != 2) {
+				fputs("Error at the spec line.\n", stderr);
+				return 0;
+			}
+			goto spec_read;
+		default:
+			fputs("Spec line missing, malformed file.\n", stderr);
+			return 0;
+	}
+	fputs("Spec line missing, malformed file.\n", stderr);
+	return 0;
+spec_read:
+
+	formula_add_vars(f, n_vars);
+	formula_reserve(f, n_vars, f->n_clauses + n_clauses);
+	while (f->lits_cap < (size_t) n_clauses * (EXPLPC + 1) + 1)
+		f->lits_cap *= 2;
+	f->lits = realloc(f->lits, f->lits_cap * sizeof * f->lits);
+
+	size_t clause_cap = 16;
+	int * clause = malloc(clause_cap * sizeof * clause);
+
+	unsigned int i_clause = 0;
+	while (i_clause < n_clauses && fgets(buffer, BUFFERSIZE, fp) != NULL) {
+		if (*buffer == 'c') { /* a comment */ }
+		else { // a clause
+			size_t n = 0;
+			char * token = strtok(buffer, " ");
+			i_clause++;
+
+			while (token != NULL) {
+				int lit = atoi(token);
+				if (lit == 0) break;
+
+				if (n == clause_cap)
+					clause = realloc(clause, (clause_cap *= 2) * sizeof * clause);
+				clause[n++] = lit;
+				token = strtok(NULL, " ");
+			}
+			formula_add_clause(f, clause, n);
+		}
+	}
+	free(clause);
+
+	if (i_clause != n_clauses) {
+		fprintf(stderr, "%u/%u clauses are missing.\n", n_clauses - i_clause, n_clauses);
+		return 0;
+	}
+
+	if (ferror(fp)) {
+		perror("Error reading file.");
+		return 0;
+	}
+
+	return 1;
+}
+
+/* Hash of the clauses, the same however they and their literals are
+ * ordered or literals repeated in them, in two independent halves.
+ * Each clause is hashed over its sorted literals, and the clauses
+ * are summed, which leaves out the order.
+ */
+void formula_canonical_hash(const formula * f, uint64_t hash[2])
+{
+	size_t cap = 16;
+	int * clause = malloc(cap * sizeof * clause);
+
+	hash[0] = mix64(f->n_vars);
+	hash[1] = mix64(~(uint64_t) f->n_vars);
+
+	for (int c = 1; c <= f->n_clauses; c++) {
+		size_t n = 0;
+		for (const int * lit = f->lits + f->clause_offs[c]; *lit; lit++) {
+			if (n == cap) clause = realloc(clause, (cap *= 2) * sizeof * clause);
+			clause[n++] = *lit;
+		}
+		qsort(clause, n, sizeof * clause, int_cmp);
+
+		uint64_t h0 = 0x9e3779b97f4a7c15ULL, h1 = 0x6a09e667f3bcc909ULL;
+		for (size_t i = 0; i < n; i++) if (i == 0 || clause[i] != clause[i - 1]) {
+			h0 = mix64(h0 ^ (uint32_t) clause[i]);
+			h1 = mix64(h1 + (uint32_t) clause[i]);
+		}
+		hash[0] += mix64(h0);
+		hash[1] += mix64(h1 ^ 0xbb67ae8584caa73bULL);
+	}
+
+	free(clause);
+}
+
+/* ==== Proof Functions ==== */
+/* Proofs of unsatisfiability are written in DRAT, binary by
+ * default, as the depth-first searcher goes. Its proof is the
+ * tree of decisions itself:
+ *   - a pure literal l at a node with decisions d1, ..., dk
+ *     makes the lemma (l -d1 ... -dk), which is RAT on l
+ *     since every clause with -l is satisfied there
+ *   - a node that fails, or whose both children failed,
+ *     makes the lemma (-d1 ... -dk), which is RUP
+ * and the root failing makes the empty clause. Lemmas of a
+ * subtree are deleted once the subtree is closed, as they are
+ * of no use after the lemma of its root.
+ *
+ * Writes go to one of two buffers while a writer thread
+ * drains the other one to the file, so that the searcher
+ * rarely waits for the disk.
+ */
+#define PROOF_BUFFERSIZE (1 << 20)
+
+struct drat_proof_tag {
+	FILE * fp;
+	int binary;
+
+	char * bufs[2];		// filled by the searcher, drained by the writer
+	size_t lens[2];
+	int active;			// buffer the searcher is filling
+	int pending;		// buffer handed to the writer, -1 if none
+	int done;
+	pthread_t writer;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+
+	int * path;			// decisions from the root to the current node
+	size_t depth;
+	int * lemmas;		// lemmas alive, each terminated with a 0
+	size_t lemmas_len;
+	size_t lemmas_cap;
+	size_t * marks;		// lemmas_len when entering the node at each depth
+};
+
+void * proof_writer(void * arg)
+{
+	drat_proof * pf = arg;
+
+	pthread_mutex_lock(&pf->lock);
+	for (;;) {
+		while (pf->pending < 0 && !pf->done)
+			pthread_cond_wait(&pf->cond, &pf->lock);
+		if (pf->pending < 0) break;
+
+		int i = pf->pending;
+		pthread_mutex_unlock(&pf->lock);
+		fwrite(pf->bufs[i], 1, pf->lens[i], pf->fp);
+		pthread_mutex_lock(&pf->lock);
+
+		pf->lens[i] = 0;
+		pf->pending = -1;
+		pthread_cond_broadcast(&pf->cond);
+	}
+	pthread_mutex_unlock(&pf->lock);
+
+	return NULL;
+}
+
+// Hands the active buffer to the writer, once it is done with the other one
+void proof_flush(drat_proof * pf)
+{
+	pthread_mutex_lock(&pf->lock);
+	while (pf->pending >= 0)
+		pthread_cond_wait(&pf->cond, &pf->lock);
+	pf->pending = pf->active;
+	pf->active ^= 1;
+	pthread_cond_broadcast(&pf->cond);
+	pthread_mutex_unlock(&pf->lock);
+}
+
+drat_proof * proof_open(const char * path, int binary, const formula * f)
+{
+	FILE * fp = fopen(path, binary ? "wb" : "w");
+	if (fp == NULL) {
+		perror("Error opening proof file to write.");
+		return NULL;
+	}
+
+	drat_proof * pf = calloc(1, sizeof * pf);
+	pf->fp = fp;
+	pf->binary = binary;
+	pf->bufs[0] = malloc(PROOF_BUFFERSIZE);
+	pf->bufs[1] = malloc(PROOF_BUFFERSIZE);
+	pf->pending = -1;
+
+	pf->path = malloc((f->n_vars + 1) * sizeof * pf->path);
+	pf->marks = calloc(f->n_vars + 2, sizeof * pf->marks);
+	pf->lemmas_cap = 1024;
+	pf->lemmas = malloc(pf->lemmas_cap * sizeof * pf->lemmas);
+
+	pthread_mutex_init(&pf->lock, NULL);
+	pthread_cond_init(&pf->cond, NULL);
+	pthread_create(&pf->writer, NULL, proof_writer, pf);
+	return pf;
+}
+
+void proof_close(drat_proof * pf)
+{
+	proof_flush(pf);
+
+	pthread_mutex_lock(&pf->lock);
+	pf->done = 1;
+	pthread_cond_broadcast(&pf->cond);
+	pthread_mutex_unlock(&pf->lock);
+	pthread_join(pf->writer, NULL);
+
+	if (ferror(pf->fp) | fclose(pf->fp))
+		perror("Error writing proof.");
+
+	pthread_mutex_destroy(&pf->lock);
+	pthread_cond_destroy(&pf->cond);
+	free(pf->bufs[0]);
+	free(pf->bufs[1]);
+	free(pf->path);
+	free(pf->marks);
+	free(pf->lemmas);
+	free(pf);
+}
+
+/* Binary literals are 2 * var, plus one if negative, in
+ * little-endian groups of 7 bits with the 8th set on all
+ * but the last one.
+ */
+void proof_put_lit(drat_proof * pf, int lit)
+{
+	char * buf = pf->bufs[pf->active];
+	size_t * len = &pf->lens[pf->active];
+
+	if (pf->binary) {
+		unsigned int u = 2U * abs(lit) + (lit < 0);
+		while (u > 127) {
+			buf[(*len)++] = (char) (u & 127) | 128;
+			u >>= 7;
+		}
+		buf[(*len)++] = (char) u;
+	}
+	else {
+		*len = put_int(buf + *len, lit) - buf;
+		buf[(*len)++] = lit ? ' ' : '\n';
+	}
+}
+
+// Writes a line, 'a' for adding a lemma, 'd' for deleting one
+void proof_put(drat_proof * pf, char kind, const int * lits, size_t n)
+{
+	if (pf->lens[pf->active] + (n + 2) * 12 > PROOF_BUFFERSIZE)
+		proof_flush(pf);
+
+	char * buf = pf->bufs[pf->active];
+	size_t * len = &pf->lens[pf->active];
+
+	if (pf->binary)
+		buf[(*len)++] = kind;
+	else if (kind == 'd') {
+		buf[(*len)++] = 'd';
+		buf[(*len)++] = ' ';
+	}
+
+	for (size_t i = 0; i < n; i++)
+		proof_put_lit(pf, lits[i]);
+	proof_put_lit(pf, 0);
+}
+
+// Adds a lemma made of lit, if not 0, and negation of the decisions
+void proof_lemma(drat_proof * pf, int lit)
+{
+	size_t n = pf->depth + (lit != 0);
+	while (pf->lemmas_len + n + 1 > pf->lemmas_cap) {
+		pf->lemmas_cap *= 2;
+		pf->lemmas = realloc(pf->lemmas, pf->lemmas_cap * sizeof * pf->lemmas);
+	}
+
+	int * lemma = pf->lemmas + pf->lemmas_len;
+	int * p = lemma;
+	if (lit != 0) *p++ = lit; // the pivot of RAT comes first
+	for (size_t i = 0; i < pf->depth; i++)
+		*p++ = -pf->path[i];
+	*p = 0;
+
+	proof_put(pf, 'a', lemma, n);
+	pf->lemmas_len += n + 1;
+}
+
+// Records the decision leading to the node at depth, whose lemmas follow
+void proof_enter(drat_proof * pf, size_t depth, int decision)
+{
+	if (depth > 0) pf->path[depth - 1] = decision;
+	pf->depth = depth;
+	pf->marks[depth] = pf->lemmas_len;
+}
+
+void proof_pure(drat_proof * pf, int lit)
+{
+	proof_lemma(pf, lit);
+}
+
+/* The node at depth has failed, or both of its children have.
+ * Its lemma replaces all of the ones from the subtree under it,
+ * which are deleted only after it is added, as it follows them.
+ */
+void proof_fail(drat_proof * pf, size_t depth)
+{
+	size_t from = pf->marks[depth];
+	size_t to = pf->lemmas_len;
+
+	pf->depth = depth;
+	proof_lemma(pf, 0);
+
+	for (size_t i = from; i < to; ) {
+		size_t n = 0;
+		while (pf->lemmas[i + n]) n++;
+		proof_put(pf, 'd', pf->lemmas + i, n);
+		i += n + 1;
+	}
+
+	memmove(pf->lemmas + from, pf->lemmas + to,
+		(pf->lemmas_len - to) * sizeof * pf->lemmas);
+	pf->lemmas_len -= to - from;
+}
+
+/* ==== Configuration Functions ==== */
+/* Configurations are descriptors of states with
+ * minimum memory footprint. They store:
+ *   - satisfied clause information
+ *   - negative variable assignments
+ *   - positive variable assignments
+ * The actual formula state can be recovered using
+ * the initial formula that stays constant, and using
+ * configurations.
+ *
+ * Specification:
+ *   - cconf, an array of bitstores where 1 in an index
+ *            means that the corresponding (c)lause is
+ *            satisfied
+ *   - nconf, an array of bitstores where 1 in an index
+ *            means that the corresponding literal is
+ *            fixed to be (n)egative, i.e. False
+ *   - pconf, similar to nconf
+ */
+bitstore * copy_config_to(const formula * f, bitstore * dest, bitstore * config)
+{
+	prof_scope(PROF_COPY);
+	return memcpy(dest, config, f->cfg_size);
+}
+
+bitstore * copy_config(const formula * f, bitstore * config)
+{
+	return copy_config_to(f, malloc(f->cfg_size), config);
+}
+
+/* Bit-storage makes some operations a breeze
+ * and this is one of its finest depictions.
+ */
+void lit_propagate(solver * s, bitstore * cconf, int lit)
+{
+	bitstore * occurlist = s->f->occurlists[lit];
+	stat_inc(s, propagations);
+	for (int i = 0; i < s->f->cconf_len; i++)
+		cconf[i] |= occurlist[i];
+}
+
+void var_assign(solver * s, bitstore * config, int var, int ispos)
+{
+	bitstore * cconf = config;
+	bitstore * nconf = config + s->f->cconf_len;
+	bitstore * pconf = nconf + s->f->olconf_len;
+
+	bitstore * xconf;
+	int lit;
+
+	if (ispos) xconf = pconf, lit = var;
+	else       xconf = nconf, lit = -var;
+
+	if (s->reasons != NULL) s->reasons[var] = 0;
+	s_set(xconf, var);
+	lit_propagate(s, cconf, lit);
+}
+
+void lit_assign(solver * s, bitstore * config, int lit)
+{
+	bitstore * cconf = config;
+	bitstore * nconf = config + s->f->cconf_len;
+	bitstore * pconf = nconf + s->f->olconf_len;
+
+	bitstore * xconf;
+	int var;
+
+	if (lit > 0) xconf = pconf, var = lit;
+	else         xconf = nconf, var = -lit;
+
+	if (s->reasons != NULL) s->reasons[var] = 0;
+	s_set(xconf, var);
+	lit_propagate(s, cconf, lit);
+}
+
+int clause_length(const formula * f, bitstore * config, int clause_i)
+{
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+	bitstore * pclause = f->clauses[clause_i];
+	bitstore * nclause = f->clauses[-clause_i];
+
+	int c = 0;
+	for (int i = 0; i < f->olconf_len; i++) {
+		/* Count the positive literals in clauses which (&)
+		 * are not (~) set to its negative.
+		 * Vice versa.
+		 */
+		c += count_bits(pclause[i] & ~nconf[i]);
+		c += count_bits(nclause[i] & ~pconf[i]);
+	}
+
+	return c;
+}
+
+unsigned int e_occurrence_unsat(const formula * f, bitstore * cconf, int lit)
+{
+	bitstore * occurlist = f->occurlists[lit];
+	for (int i = 0; i < f->cconf_len; i++)
+		if (occurlist[i] & ~cconf[i])
+			// Occurrences that are (&) not (~) satisfied.
+			return 1U;
+	return 0U;
+}
+
+unsigned int var_state(const formula * f, bitstore * cconf, int var)
+{
+	return
+		e_occurrence_unsat(f, cconf, -var) << 1 |
+		e_occurrence_unsat(f, cconf, var);
+}
+
+unsigned int ass_state(bitstore * nconf, bitstore * pconf, int var)
+{
+	return
+		!!is_s_set(nconf, var) << 1 |
+		!!is_s_set(pconf, var);
+}
+
+/* Value of a variable in a satisfying configuration.
+ * Undetermined ones are depicted as 1, and the ones
+ * set for both as 0, the latter shouldn't happen.
+ */
+int var_value(const formula * f, bitstore * config, int var)
+{
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+
+	switch (ass_state(nconf, pconf, var)) {
+		case 0b00:
+#if DEBUG
+			printf("Var #%d is unset\n", var);
+#endif
+		case 0b01:
+			return 1;
+		case 0b11:
+#if DEBUG
+			printf("Var #%d is set for both\n", var);
+#endif
+		default:
+			return 0;
+	}
+}
+
+/* Assignments are formatted into a single buffer and
+ * written at once, since a call to fprintf per variable
+ * takes seconds on models with millions of variables.
+ * Longest line is "-2147483648 0\n" or "v -2147483648".
+ */
+#define MAX_ASSIGNMENT_LEN 14
+
+// One "var value" line per variable, the format the verifier expects
+void print_assignments(const formula * f, bitstore * config, FILE * stream)
+{
+	unsigned int n_vars = f->n_vars - f->n_aux_vars;
+	char * buf = malloc((size_t) n_vars * MAX_ASSIGNMENT_LEN + 1);
+	char * p = buf;
+
+	for (int i = 1; i <= n_vars; i++) {
+		p = put_int(p, i);
+		*p++ = ' ';
+		*p++ = '0' + var_value(f, config, i);
+		*p++ = '\n';
+	}
+
+	fwrite(buf, 1, p - buf, stream);
+	free(buf);
+}
+
+/* Result in the SAT competition format: a solution line, and
+ * for satisfiable ones the model in value lines, each one
+ * with at most 80 characters, terminated with a 0.
+ */
+void print_competition(const formula * f, dpll_result result, bitstore * config, FILE * stream)
+{
+	if (result != SUCCESS) {
+		fputs(result == FAIL ? "s UNSATISFIABLE\n" : "s UNKNOWN\n", stream);
+		return;
+	}
+
+	unsigned int n_vars = f->n_vars - f->n_aux_vars;
+	char * buf = malloc((size_t) (n_vars + 1) * MAX_ASSIGNMENT_LEN + 32);
+	char * p = buf;
+	char * line = p;
+
+	p = memcpy(p, "s SATISFIABLE\nv", 15) + 15;
+	line = p - 1;
+	for (int i = 1; i <= n_vars + 1; i++) {
+		int lit = (i > n_vars) ? 0 : var_value(f, config, i) ? i : -i;
+		if (p - line > 80 - 12) {
+			*p++ = '\n';
+			line = p;
+			*p++ = 'v';
+		}
+		*p++ = ' ';
+		p = put_int(p, lit);
+	}
+	*p++ = '\n';
+
+	fwrite(buf, 1, p - buf, stream);
+	free(buf);
+}
+
+int lit_occurrence_count(const formula * f, bitstore * cconf, int lit)
+{
+	int c = 0;
+	bitstore * occurlist = f->occurlists[lit];
+
+	for (int i = 0; i < f->cconf_len; i++)
+		// Count occurrences that are (&) not (~) satisfied.
+		c += count_bits(occurlist[i] & ~cconf[i]);
+	return c;
+}
+
+int var_occurrence_count(const formula * f, bitstore * cconf, int var)
+{
+	return
+		lit_occurrence_count(f, cconf, var) +
+		lit_occurrence_count(f, cconf, -var);
+}
+
+int sat_count(const formula * f, bitstore * cconf)
+{
+	int c = 0;
+	for (int i = 0; i < f->cconf_len; i++)
+		c += count_bits(cconf[i]);
+	return c;
+}
+
+int all_satisfied(const formula * f, bitstore * cconf)
+{
+	return sat_count(f, cconf) == f->n_clauses;
+}
+
+int get_unit(const formula * f, bitstore * config, int clause_i)
+{
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+	bitstore * pclause = f->clauses[clause_i];
+	bitstore * nclause = f->clauses[-clause_i];
+
+	bitstore temp;
+	for (int i = 0; i < f->olconf_len; i++) {
+		/* Negative literals in a clause that are (&)
+		 * not (~) set to its positive.
+		 * Vice versa.
+		 */
+		temp = nclause[i] & ~pconf[i];
+		if (temp) return -(least_bit_pos(temp) + i * sbitstore);
+
+		temp = pclause[i] & ~nconf[i];
+		if (temp) return least_bit_pos(temp) + i * sbitstore;
+	}
+
+	return 0;
+}
+
+/* Reductions arising from clause length, which are:
+ *   - empty clause indicating impossibility to satisfy
+ *   - unit clause calling for literal assignment/propagation
+ */
+int c_len_reductions(solver * s, bitstore * config)
+{
+	prof_scope(PROF_C_LEN);
+	const formula * f = s->f;
+	bitstore * cconf = config;
+	int last_edit = f->n_clauses + 1;
+	s->conflict = 0;
+
+	for (int i = 1; i != last_edit; i++) {
+		if (i == f->n_clauses + 1) i = 1;
+		if (is_s_set(cconf, i)) continue;
+
+		switch (clause_length(f, config, i)) {
+			case 0:
+				s->conflict = i;
+				return 0;
+			case 1: {
+				int lit = get_unit(f, config, i);
+				lit_assign(s, config, lit);
+				if (s->reasons != NULL) s->reasons[abs(lit)] = i;
+				last_edit = (i == 1) ? (f->n_clauses + 1) : i;
+			}
+		}
+	}
+
+	return 1;
+}
+
+void card_refresh(solver * s, bitstore * config);
+unsigned int card_state(const solver * s, int var);
+
+void purity_reduction(solver * s, bitstore * config)
+{
+	prof_scope(PROF_PURITY);
+	const formula * f = s->f;
+	bitstore * cconf = config;
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+	int last_edit = f->n_vars + 1;
+
+	if (s->cards != NULL)
+		card_refresh(s, config);
+
+	for (int i = 1; i != last_edit; i++) {
+		if (i == f->n_vars + 1) i = 1;
+		if (is_s_set(pconf, i) || is_s_set(nconf, i)) continue;
+
+		switch (var_state(f, cconf, i) | card_state(s, i)) {
+			case 0b01:
+				if (s->proof != NULL) proof_pure(s->proof, i);
+				stat_inc(s, pure_literals);
+				var_assign(s, config, i, 1);
+				last_edit = (i == 1) ? (f->n_vars + 1) : i;
+				break;
+			case 0b10:
+				if (s->proof != NULL) proof_pure(s->proof, -i);
+				stat_inc(s, pure_literals);
+				var_assign(s, config, i, 0);
+				last_edit = (i == 1) ? (f->n_vars + 1) : i;
+				break;
+			case 0b00:
+				var_assign(s, config, i, 1);
+				break;
+		}
+	}
+}
+
+// UNUSED first non-determined variable
+int var_choose_first(const formula * f, bitstore * config)
+{
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+
+	for (int i = 1; i <= f->n_vars; i++)
+		if (ass_state(nconf, pconf, i) == 0b00)
+			return i;
+	return 0;
+}
+
+// UNUSED last non-determined variable
+int var_choose_last(const formula * f, bitstore * config)
+{
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+
+	for (int i = f->n_vars; i > 0; i++)
+		if (ass_state(nconf, pconf, i) == 0b00)
+			return i;
+	return 0;
+}
+
+// UNUSED most frequent non-determined variable
+int var_choose_max_occur(const formula * f, bitstore * config)
+{
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+
+	int max = 0;
+	int max_i = 0;
+
+	for (int i = 1; i <= f->n_vars; i++) {
+		if (ass_state(nconf, pconf, i) == 0b00) {
+			int n_occ = var_occurrence_count(f, config, i);
+			if (n_occ > max) {
+				max = n_occ;
+				max_i = i;
+			}
+		}
+	}
+
+	return max_i;
+}
+
+// UNUSED least frequent non-determined variable
+int var_choose_min_occur(const formula * f, bitstore * config)
+{
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+
+	int min = 2 * f->n_clauses;
+	int min_i = 0;
+
+	for (int i = 1; i <= f->n_vars; i++) {
+		if (ass_state(nconf, pconf, i) == 0b00) {
+			int n_occ = var_occurrence_count(f, config, i);
+			if (n_occ < min) {
+				min = n_occ;
+				min_i = i;
+			}
+		}
+	}
+
+	return min_i;
+}
+
+// UNUSED most frequent non-determined literal
+int lit_choose_max_occur(const formula * f, bitstore * config)
+{
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+
+	int max = 0;
+	int max_i = 0;
+
+	for (int i = 1; i <= f->n_vars; i++) {
+		if (ass_state(nconf, pconf, i) == 0b00) {
+			int n_occ_pos = var_occurrence_count(f, config, i);
+			int n_occ_neg = var_occurrence_count(f, config, -i);
+			if (n_occ_pos > max) {
+				max = n_occ_pos;
+				max_i = i;
+			}
+			if (n_occ_neg > max) {
+				max = n_occ_neg;
+				max_i = -i;
+			}
+		}
+	}
+
+	return max_i;
+}
+
+// UNUSED least frequent non-determined literal
+int lit_choose_min_occur(const formula * f, bitstore * config)
+{
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+
+	int min = f->n_clauses;
+	int min_i = 0;
+
+	for (int i = 1; i <= f->n_vars; i++) {
+		if (ass_state(nconf, pconf, i) == 0b00) {
+			int n_occ_pos = var_occurrence_count(f, config, i);
+			int n_occ_neg = var_occurrence_count(f, config, -i);
+			if (n_occ_pos < min) {
+				min = n_occ_pos;
+				min_i = i;
+			}
+			if (n_occ_neg < min) {
+				min = n_occ_neg;
+				min_i = -i;
+			}
+		}
+	}
+
+	return min_i;
+}
+
+/* An important function counting the occurrences, and
+ * calculating a power measure for a given literal.
+ * Power is the number of clauses in which this literal
+ * exists along with one and only one another literal.
+ *
+ * Importance of power is that, if this literal is set
+ * to be False, then the other literal in the clause will
+ * be a unit literal, causing further propagations.
+ */
+pair lit_oc_and_p(const formula * f, bitstore * config, int lit)
+{
+	bitstore * cconf = config;
+	bitstore * occurlist = f->occurlists[lit];
+	pair cp = { 0, 0 };
+
+	for (int i = 0; i < f->cconf_len; i++) {
+		bitstore occ = ~cconf[i] & occurlist[i];
+		while (occ) {
+			int pos = least_bit_pos(occ);
+			cp.a++;
+			if (clause_length(f, config, i * 8 * sizeof occ + pos) == 2)
+				cp.b++;
+			occ &= ~bit(pos);
+		}
+	}
+
+	return cp;
+}
+
+/* [USED!] Literal with the highest score.
+ * Score for a literal is the sum of:
+ *   - Number of clauses in which the literal
+ *     occurs
+ *   - (f)actor times the power of the negative
+ *     of the literal where (f)actor is current
+ *     estimate for mean occurrence count of a
+ *     variable
+ *   - The above two for the negative of the
+ *     literal, multiplied by 0.75
+ *
+ * The rationale behind the score is:
+ *   - Number of occurrences of the literal itself
+ *     will be the amount of clauses that will be
+ *     cleaned up
+ *   - Power of the literal will generate that many
+ *     unit clauses, each one cleaning up (f)actor
+ *     many clauses, and more
+ *   - In case of wrong decision, the opposite
+ *     should not be in bad condition, either
+ */
+int lit_choose_max_occur_power(const formula * f, bitstore * config)
+{
+	prof_scope(PROF_CHOOSE);
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+
+	int max = -1;
+	int max_i = 0;
+
+	for (int var = 1; var <= f->n_vars; var++)
+	if (ass_state(nconf, pconf, var) == 0b00) {
+		pair cp_pos = lit_oc_and_p(f, config, var);
+		pair cp_neg = lit_oc_and_p(f, config, -var);
+
+		int unsat_count = f->n_clauses - sat_count(f, config);
+		int fac = round_pos(f->mean_occ_len * unsat_count / f->n_clauses);
+		int score_pos = cp_pos.a + fac * cp_neg.b;
+		int score_neg = cp_neg.a + fac * cp_pos.b;
+
+		int temp = score_pos;
+		score_pos += score_neg * 0.75;
+		score_neg += temp * 0.75;
+
+		if (score_pos > max) max = score_pos, max_i = var;
+		if (score_neg > max) max = score_neg, max_i = -var;
+	}
+
+	return max_i;
+}
+
+// The literal both searchers decide on
+int lit_choose(solver * s, bitstore * config)
+{
+	phase_begin(PHASE_CHOOSE);
+	int choice = lit_choose_max_occur_power(s->f, config);
+	phase_end(s, PHASE_CHOOSE);
+	return choice;
+}
+
+// Sanity check for debugging purposes under failure
+void sanity(const formula * f, bitstore * config)
+{
+	bitstore * cconf = config;
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+
+	for (int i = 1; i <= f->n_clauses; i++) {
+		bitstore * pclause = f->clauses[i];
+		bitstore * nclause = f->clauses[-i];
+		int ok = 0;
+		if (is_s_set(cconf, i)) {
+			for (int j = 0; j < f->olconf_len; j++) {
+				if (pclause[j] & pconf[j] || nclause[j] & nconf[j]) {
+					ok = 1;
+					break;
+				}
+			}
+			if (!ok)
+				printf("insanity: c%d satisfied, no lits of it is true\n", i);
+		}
+		else {
+			ok = 1;
+			for (int j = 0; j < f->olconf_len; j++) {
+				if (pclause[j] & pconf[j] || nclause[j] & nconf[j]) {
+					ok = 0;
+					printf("insanity: c%d unsat, with some lits true\n", i);
+					break;
+				}
+			}
+		}
+
+		if (!ok) {
+			puts("something's not ok");
+		}
+	}
+}
+
+int xor_propagate(solver * s, bitstore * config);
+int card_propagate(solver * s, bitstore * config);
+
+/* Units of the clauses, of the XORs and of the cardinality
+ * constraints, until none has any more, 0 on a conflict.
+ */
+int unit_reductions(solver * s, bitstore * config)
+{
+	int assigned = 1;
+
+	while (assigned > 0) {
+		if (!c_len_reductions(s, config))
+			return 0;
+		assigned = (s->xors != NULL) ? xor_propagate(s, config) : 0;
+		if (assigned == 0 && s->cards != NULL)
+			assigned = card_propagate(s, config);
+	}
+
+	return assigned == 0;
+}
+
+/* Makes a DPLL configuration advance by a step,
+ * results in FAIL, SUCCESS, or TBD (to-be-determined).
+ */
+dpll_result dpll_step(solver * s, bitstore * config)
+{
+	dpll_result result = TBD;
+	phase_begin(PHASE_REDUCE);
+
+	if (!unit_reductions(s, config))
+		result = FAIL;
+	else {
+		purity_reduction(s, config);
+		if (all_satisfied(s->f, config))
+			result = SUCCESS;
+	}
+
+	phase_end(s, PHASE_REDUCE);
+	return result;
+}
+
+/* ==== XOR Functions ==== */
+/* An XOR of k variables, x1 + ... + xk = b over GF(2), takes the
+ * 2^(k-1) clauses on those variables with the signs of an odd, or
+ * an even, number of them negated: each clause rules out the one
+ * assignment falsifying it, of the parity of its negations. XORs are
+ * found among the clauses of up to XOR_MAX_LEN variables, grouped by
+ * their variables, and kept as rows of bits over the variables along
+ * with their right-hand sides. At every step, the rows reduced by the
+ * assignments are brought into reduced row echelon form, by Gauss-
+ * Jordan elimination, where an empty row with b = 1 is a conflict and
+ * a row of a single variable assigns it. The clauses stay in the
+ * formula, the rows only find what follows from them sooner.
+ */
+#define XOR_MAX_LEN 6
+
+struct xor_system_tag {
+	int n_rows;
+	size_t words;			// in each row, olconf_len when found
+	bitstore * rows;		// variables of each XOR, words apart
+	unsigned char * rhs;
+	bitstore * m;			// rows being eliminated at a step
+	unsigned char * b;
+};
+
+typedef
+struct xor_clause_tag {
+	int vars[XOR_MAX_LEN];	// sorted
+	int k;
+	int negs;				// bit i for the i-th variable negated
+} xor_clause;
+
+int xor_clause_cmp(const void * a, const void * b)
+{
+	const xor_clause * x = a;
+	const xor_clause * y = b;
+
+	if (x->k != y->k) return x->k - y->k;
+	for (int i = 0; i < x->k; i++)
+		if (x->vars[i] != y->vars[i]) return (x->vars[i] > y->vars[i]) - (x->vars[i] < y->vars[i]);
+	return 0;
+}
+
+int parity(bitstore w)
+{
+	return count_bits(w) & 1;
+}
+
+void xor_push(xor_system * x, const int * vars, int k, int rhs)
+{
+	x->rows = realloc(x->rows, (x->n_rows + 1) * x->words * sizeof * x->rows);
+	x->rhs = realloc(x->rhs, x->n_rows + 1);
+
+	bitstore * row = x->rows + x->n_rows * x->words;
+	memset(row, 0, x->words * sizeof * row);
+	for (int i = 0; i < k; i++)
+		s_set(row, vars[i]);
+	x->rhs[x->n_rows++] = rhs;
+}
+
+// XORs encoded by the clauses, NULL if there are none
+xor_system * xor_find(const formula * f)
+{
+	xor_clause * cls = malloc((f->n_clauses + 1) * sizeof * cls);
+	size_t n = 0;
+
+	for (int c = 1; c <= f->n_clauses; c++) {
+		xor_clause * xc = &cls[n];
+		int lits[XOR_MAX_LEN];
+		int k = 0, ok = 1;
+
+		for (const int * lit = f->lits + f->clause_offs[c]; *lit && ok; lit++) {
+			if (k == XOR_MAX_LEN) ok = 0;
+			else lits[k++] = *lit;
+		}
+		if (!ok || k < 2) continue;
+
+		// sorted by the variables, ones repeated or both ways are no part of an XOR
+		for (int i = 1; i < k; i++)
+			for (int j = i; j > 0 && abs(lits[j - 1]) > abs(lits[j]); j--) {
+				int t = lits[j]; lits[j] = lits[j - 1]; lits[j - 1] = t;
+			}
+		xc->k = k;
+		xc->negs = 0;
+		for (int i = 0; i < k; i++) {
+			if (i > 0 && abs(lits[i]) == abs(lits[i - 1])) ok = 0;
+			xc->vars[i] = abs(lits[i]);
+			if (lits[i] < 0) xc->negs |= 1 << i;
+		}
+		if (ok) n++;
+	}
+	qsort(cls, n, sizeof * cls, xor_clause_cmp);
+
+	xor_system * x = calloc(1, sizeof * x);
+	x->words = f->olconf_len;
+
+	for (size_t i = 0, j; i < n; i = j) {
+		uint64_t seen[(1 << XOR_MAX_LEN) / 64 + 1] = { 0 };
+		int count[2] = { 0, 0 };
+
+		for (j = i; j < n && xor_clause_cmp(&cls[i], &cls[j]) == 0; j++) {
+			int negs = cls[j].negs;
+			if (seen[negs / 64] & (1ULL << (negs % 64))) continue;
+			seen[negs / 64] |= 1ULL << (negs % 64);
+			count[parity(negs)]++;
+		}
+
+		// all the assignments of one parity ruled out leave the other
+		for (int p = 0; p < 2; p++)
+			if (count[p] == 1 << (cls[i].k - 1))
+				xor_push(x, cls[i].vars, cls[i].k, !p);
+	}
+	free(cls);
+
+	if (x->n_rows == 0) {
+		free(x);
+		return NULL;
+	}
+	x->m = malloc(x->n_rows * x->words * sizeof * x->m);
+	x->b = malloc(x->n_rows);
+	return x;
+}
+
+void xor_free(xor_system * x)
+{
+	if (x == NULL) return;
+	free(x->rows);
+	free(x->rhs);
+	free(x->m);
+	free(x->b);
+	free(x);
+}
+
+/* Eliminates the XORs under the assignments of the configuration,
+ * assigning the variables they imply. Returns the number of those,
+ * or -1 on a conflict.
+ */
+int xor_propagate(solver * s, bitstore * config)
+{
+	const formula * f = s->f;
+	xor_system * x = s->xors;
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+	size_t words = x->words;
+	int n_rows = 0;
+
+	// rows of the unassigned variables, the true ones moved to the right
+	for (int r = 0; r < x->n_rows; r++) {
+		bitstore * row = x->rows + r * words;
+		bitstore * m = x->m + n_rows * words;
+		bitstore any = 0;
+		int b = x->rhs[r];
+
+		for (size_t j = 0; j < words; j++) {
+			m[j] = row[j] & ~(nconf[j] | pconf[j]);
+			b ^= parity(row[j] & pconf[j]);
+			any |= m[j];
+		}
+		if (any) x->b[n_rows++] = b;
+		else if (b) return -1;
+	}
+
+	for (int i = 0; i < n_rows; i++) {
+		bitstore * mi = x->m + i * words;
+		size_t j = 0;
+		while (j < words && mi[j] == 0) j++;
+		if (j == words) {
+			if (x->b[i]) return -1;
+			continue;
+		}
+
+		bitstore pivot = mi[j] & -mi[j];
+		for (int r = 0; r < n_rows; r++) {
+			bitstore * mr = x->m + r * words;
+			if (r == i || !(mr[j] & pivot)) continue;
+			for (size_t w = j; w < words; w++)
+				mr[w] ^= mi[w];
+			x->b[r] ^= x->b[i];
+		}
+	}
+
+	int assigned = 0;
+	for (int i = 0; i < n_rows; i++) {
+		bitstore * mi = x->m + i * words;
+		int n_vars = 0, var = 0;
+
+		for (size_t j = 0; j < words && n_vars < 2; j++)
+			if (mi[j]) {
+				n_vars += count_bits(mi[j]);
+				var = j * sbitstore + least_bit_pos(mi[j]);
+			}
+		if (n_vars != 1) continue;
+
+		stat_inc(s, xor_units);
+		lit_assign(s, config, x->b[i] ? var : -var);
+		assigned++;
+	}
+
+	return assigned;
+}
+
+/* ==== Verification Functions ==== */
+/* Checks the assignments of a configuration of the formula against
+ * clauses given as a flat literal array, each terminated with a 0,
+ * such as the ones the formula was read with before preprocessing
+ * rewrote them, in a single pass. Returns 0 if all of them are
+ * satisfied, otherwise the index of the first clause that is not.
+ */
+unsigned int verify_clauses(const formula * f, bitstore * config, const int * lits, size_t lits_len)
+{
+	unsigned int i_clause = 1;
+	int satisfied = 0;
+
+	for (size_t i = 0; i < lits_len; i++) {
+		int lit = lits[i];
+		if (lit == 0) {
+			if (!satisfied) return i_clause;
+			satisfied = 0;
+			i_clause++;
+		}
+		else if (!satisfied)
+			satisfied = abs(lit) <= f->n_vars && var_value(f, config, abs(lit)) == (lit > 0);
+	}
+
+	return 0;
+}
+
+/* Checks the assignments of a configuration against the clauses
+ * of the formula, then against its cardinality constraints. Returns
+ * 0 if all of them are satisfied, otherwise the index of the first
+ * clause that is not, the constraints numbered on from the last
+ * clause.
+ */
+unsigned int verify_model(const formula * f, bitstore * config)
+{
+	unsigned int failed = verify_clauses(f, config, f->lits, f->lits_len);
+	if (failed) return failed;
+
+	const int * p = f->cards;
+	for (unsigned int i = 0; i < f->n_cards; i++, p++) {
+		int n_true = 0;
+		for (; *p; p++)
+			n_true += var_value(f, config, abs(*p)) == (*p > 0);
+		if (n_true > 1) return f->n_clauses + i + 1;
+	}
+
+	return 0;
+}
+
+/* Reads assignments into a configuration, given either as
+ * "var value" lines or as the value lines of the competition
+ * format. Variables left out are taken as 0, as the verifier does.
+ */
+int read_model(const formula * f, FILE * fp, bitstore * config)
+{
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+	int competition = 0;
+	int c, var, value;
+
+	memset(config, 0, f->cfg_size);
+	for (int i = 1; i <= f->n_vars; i++)
+		s_set(nconf, i);
+
+	while ((c = getc(fp)) != EOF) {
+		if (c == 'c' || c == 's') { // a comment or the solution line
+			while ((c = getc(fp)) != EOF && c != '\n');
+			continue;
+		}
+		if (c == 'v') competition = 1;
+		if (c == 'v' || isspace(c)) continue;
+
+		ungetc(c, fp);
+		if (fscanf(fp, "%d", &var) != 1) return 0;
+		if (competition) {
+			if (var == 0) continue;
+			value = var > 0;
+			var = abs(var);
+		}
+		else if (fscanf(fp, "%d", &value) != 1) return 0;
+
+		if (var < 1 || var > f->n_vars) return 0;
+
+		if (value) s_set(pconf, var), s_clear(nconf, var);
+		else       s_set(nconf, var), s_clear(pconf, var);
+	}
+
+	return !ferror(fp);
+}
+
+/* ==== Checkpoint Functions ==== */
+/* Checkpoints are compact binary snapshots of a search,
+ * taken periodically so that it can be resumed after
+ * the process is killed. The file consists of a header
+ * followed by the state of the searcher:
+ *   - breadth-first: count configurations, those
+ *     on the frontier that are still TBD
+ *   - depth-first: count frames of the decision stack,
+ *     followed by its count + 1 configurations
+ * Everything is in the native byte order and word size of
+ * the bitmaps, a checkpoint is only meant to be resumed on
+ * the machine and build taking it.
+ * There are no learned clauses to save, this DPLL does
+ * not learn any.
+ */
+#define CKPT_MAGIC   0x4b433353U // "S3CK"
+#define CKPT_VERSION 2U
+
+typedef
+struct ckpt_header_tag {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t kind;			// searcher that took the checkpoint
+	uint32_t n_vars;
+	uint32_t n_clauses;
+	uint32_t hash;			// formula_hash of the formula being solved
+	uint32_t word_bits;		// BITSTORE_BITS of the solver taking it
+	uint32_t reserved;
+	uint64_t cfg_len;
+	uint64_t count;
+} ckpt_header;
+
+// FNV-1a over the clauses, to tell if a checkpoint belongs to this formula
+uint32_t formula_hash(const formula * f)
+{
+	uint32_t h = 2166136261U;
+
+	for (int i = -(int) f->n_clauses; i <= (int) f->n_clauses; i++) {
+		if (i == 0) continue;
+		for (int j = 0; j < f->olconf_len; j++) {
+			h ^= f->clauses[i][j];
+			h *= 16777619U;
+		}
+	}
+
+	return h;
+}
+
+int ckpt_due(solver * s)
+{
+	return s->ckpt_path != NULL && monotonic_sec() - s->ckpt_last >= s->ckpt_interval;
+}
+
+/* Checkpoints are written to a temporary file first, and
+ * renamed over the previous one once complete, so that
+ * getting killed while writing leaves the last one intact.
+ */
+FILE * ckpt_begin(solver * s, searcher kind, uint64_t count)
+{
+	const formula * f = s->f;
+	char tmp_path[BUFFERSIZE];
+	snprintf(tmp_path, sizeof tmp_path, "%s.tmp", s->ckpt_path);
+
+	FILE * fp = fopen(tmp_path, "wb");
+	if (fp == NULL) {
+		perror("Error opening checkpoint file to write.");
+		return NULL;
+	}
+
+	ckpt_header header = {
+		CKPT_MAGIC, CKPT_VERSION, kind,
+		f->n_vars, f->n_clauses, formula_hash(f),
+		BITSTORE_BITS, 0, f->cfg_len, count
+	};
+	fwrite(&header, sizeof header, 1, fp);
+	return fp;
+}
+
+void ckpt_end(solver * s, FILE * fp)
+{
+	char tmp_path[BUFFERSIZE];
+	snprintf(tmp_path, sizeof tmp_path, "%s.tmp", s->ckpt_path);
+
+	if (ferror(fp) | fclose(fp) || rename(tmp_path, s->ckpt_path) != 0)
+		perror("Error writing checkpoint.");
+
+	s->ckpt_last = monotonic_sec();
+}
+
+/* Opens the checkpoint to resume from, after making sure that
+ * it was taken on the very same formula. Tells the searcher
+ * that took it, along with the count in its header.
+ */
+FILE * ckpt_resume(solver * s, searcher * kind, uint64_t * count)
+{
+	const formula * f = s->f;
+	ckpt_header header;
+	FILE * fp = fopen(s->resume_path, "rb");
+	if (fp == NULL) {
+		perror("Error opening checkpoint file.");
+		return NULL;
+	}
+
+	if (fread(&header, sizeof header, 1, fp) != 1
+		|| header.magic != CKPT_MAGIC || header.version != CKPT_VERSION
+		|| header.kind > DEPTH_FIRST) {
+		fputs("Not a checkpoint file.\n", stderr);
+	}
+	else if (header.word_bits != BITSTORE_BITS) {
+		fprintf(stderr, "Checkpoint was taken with %u-bit words, not %d.\n",
+			header.word_bits, BITSTORE_BITS);
+	}
+	else if (header.cfg_len != f->cfg_len
+		|| header.n_vars != f->n_vars || header.n_clauses != f->n_clauses
+		|| header.hash != formula_hash(f)) {
+		fputs("Checkpoint does not belong to this formula.\n", stderr);
+	}
+	else {
+		*kind = header.kind;
+		*count = header.count;
+		return fp;
+	}
+
+	fclose(fp);
+	return NULL;
+}
+
+/* ==== Budget Functions ==== */
+/* Searchers poll should_stop in between steps, and stop
+ * with TBD when it says so, leaving the reason behind.
+ * Signals stop all of the searches in the process.
+ */
+volatile sig_atomic_t interrupted = 0;
+
+// A second signal is left to the default handler, killing the process
+void on_signal(int sig)
+{
+	interrupted = sig;
+	signal(sig, SIG_DFL);
+}
+
+size_t formula_size(const formula * f)
+{
+	return
+		2 * f->n_clauses * f->olconf_len * sizeof (bitstore) +
+		2 * f->n_vars * f->cconf_len * sizeof (bitstore);
+}
+
+int component_within(component_job * job, size_t searcher_size);
+
+/* Tells whether the searcher may grow to the given size in bytes,
+ * along with the ones of the splits it searches a component of.
+ */
+int within_memory(solver * s, size_t searcher_size)
+{
+	if (s->limits.memory == 0)
+		return 1;
+	if (s->job != NULL ? component_within(s->job, searcher_size) :
+		formula_size(s->f) + searcher_size <= s->limits.memory)
+		return 1;
+
+	s->stop_reason = "memory limit";
+	return 0;
+}
+
+int should_stop(solver * s)
+{
+	if (s->stop_reason != NULL)
+		return 1;
+
+	if (interrupted)
+		s->stop_reason = (interrupted == SIGINT) ? "interrupted" : "terminated";
+	else if (s->limits.decisions && s->n_decisions >= s->limits.decisions)
+		s->stop_reason = "decision limit";
+	else if (s->limits.conflicts && s->n_conflicts >= s->limits.conflicts)
+		s->stop_reason = "conflict limit";
+	else if (s->limits.flips && s->n_flips >= s->limits.flips)
+		s->stop_reason = "flip limit";
+	else if (s->limits.time && monotonic_sec() - s->search_start >= s->limits.time)
+		s->stop_reason = "time limit";
+	else if (s->terminate != NULL && s->terminate(s->terminate_data) && s->stop_reason == NULL)
+		s->stop_reason = "terminated by the caller"; // unless it tells why
+
+	return s->stop_reason != NULL;
+}
+
+/* ==== Component Functions ==== */
+/* Unsatisfied clauses fall into connected components, two of
+ * them being in the same one when they share an unassigned
+ * variable, or are linked through others that do. Components
+ * have no say on one another, so each is satisfiable on its own
+ * or not, and its models combine freely with those of the rest.
+ */
+// Unsatisfied clauses of the configuration
+void unsat_clauses(const formula * f, const bitstore * config, bitstore * rest)
+{
+	for (int i = 0; i < f->cconf_len; i++)
+		rest[i] = ~config[i];
+	s_clear(rest, 0);
+	for (size_t c = f->n_clauses + 1; c < f->cconf_len * sbitstore; c++)
+		s_clear(rest, c);
+}
+
+// Unassigned variables of the unsatisfied clauses given
+void clause_vars(const formula * f, const bitstore * config, const bitstore * clauses, bitstore * vars)
+{
+	const bitstore * nconf = config + f->cconf_len;
+	const bitstore * pconf = nconf + f->olconf_len;
+
+	memset(vars, 0, f->olconf_len * sizeof * vars);
+	for (int i = 0; i < f->cconf_len; i++)
+		for (bitstore w = clauses[i]; w; w &= w - 1) {
+			int c = i * sbitstore + least_bit_pos(w);
+			for (int j = 0; j < f->olconf_len; j++)
+				vars[j] |= (f->clauses[c][j] | f->clauses[-c][j]) & ~(nconf[j] | pconf[j]);
+		}
+}
+
+/* Grows a component from the clause c over the clauses in rest,
+ * through the unassigned variables they share.
+ */
+void component_grow(const formula * f, const bitstore * config, const bitstore * rest, int c,
+	bitstore * comp_clauses, bitstore * comp_vars)
+{
+	const bitstore * nconf = config + f->cconf_len;
+	const bitstore * pconf = nconf + f->olconf_len;
+	bitstore * seen = calloc(f->olconf_len, sizeof * seen);
+	int changed = 1;
+
+	memset(comp_clauses, 0, f->cconf_len * sizeof * comp_clauses);
+	s_set(comp_clauses, c);
+	clause_vars(f, config, comp_clauses, comp_vars);
+
+	while (changed) {
+		changed = 0;
+		for (int j = 0; j < f->olconf_len; j++)
+			for (bitstore w = comp_vars[j] & ~seen[j]; w; w &= w - 1) {
+				int var = j * sbitstore + least_bit_pos(w);
+				s_set(seen, var);
+				for (int i = 0; i < f->cconf_len; i++) {
+					bitstore add = (f->occurlists[var][i] | f->occurlists[-var][i]) & rest[i] & ~comp_clauses[i];
+					for (; add; add &= add - 1) {
+						int d = i * sbitstore + least_bit_pos(add);
+						s_set(comp_clauses, d);
+						for (int k = 0; k < f->olconf_len; k++)
+							comp_vars[k] |= (f->clauses[d][k] | f->clauses[-d][k]) & ~(nconf[k] | pconf[k]);
+						changed = 1;
+					}
+				}
+			}
+	}
+
+	free(seen);
+}
+
+/* Depth-first SAT solver, uses less memory
+ * but takes more time.
+ *
+ * Decisions are kept on an explicit stack instead of
+ * the call stack, so that the search depth is only
+ * bounded by the memory. Level k of the stack holds:
+ *   - configs[k], the reduced configuration right
+ *     before the k-th decision
+ *   - frames[k], the literal decided at that level,
+ *     and whether it has been flipped to its negative
+ * The configuration currently being worked on lives
+ * at configs[depth], which is a copy of configs[depth - 1]
+ * with the decision applied on top of it.
+ *
+ * With backjumping, a conflict is blamed on the levels of the
+ * decisions it follows from, found from the clauses each literal
+ * was implied by, and a node whose failure does not involve its
+ * own decision fails as a whole: its other child is never tried.
+ * sets[k] holds the levels blamed for the first child of level k
+ * failing, for when the second one fails as well. Jumps farther
+ * than chrono levels backtrack chronologically instead, keeping
+ * the nodes in between, each tried the other way.
+ */
+typedef
+struct frame_tag {
+	int choice;
+	int flipped;
+} frame;
+
+typedef
+struct dfs_stack_tag {
+	solver * s;
+	bitstore * configs;
+	frame * frames;
+	size_t depth;
+	size_t capacity;
+
+	bitstore * sets;		// bitmaps of levels, olconf_len words each, if backjumping
+	bitstore * culprits;	// levels blamed for the conflict being backtracked from
+	bitstore * seen;		// variables of the conflict already followed
+	int * queue;
+} dfs_stack;
+
+int dfs_init(solver * s, dfs_stack * stack)
+{
+	const formula * f = s->f;
+
+	stack->s = s;
+	stack->capacity = (1ULL << 18) / f->cfg_size + 1;
+	if (stack->capacity > f->n_vars + 1) stack->capacity = f->n_vars + 1;
+	stack->configs = malloc(stack->capacity * f->cfg_size);
+	stack->frames = malloc(stack->capacity * sizeof * stack->frames);
+	stack->depth = 0;
+	stack->sets = stack->culprits = stack->seen = NULL;
+	stack->queue = NULL;
+
+	if (s->reasons != NULL) {
+		stack->sets = malloc(stack->capacity * f->olconf_len * sizeof * stack->sets);
+		stack->culprits = malloc(f->olconf_len * sizeof * stack->culprits);
+		stack->seen = malloc(f->olconf_len * sizeof * stack->seen);
+		stack->queue = malloc((f->n_vars + 1) * sizeof * stack->queue);
+		if (stack->sets == NULL || stack->culprits == NULL || stack->seen == NULL || stack->queue == NULL)
+			return 0;
+	}
+
+	if (stack->configs == NULL || stack->frames == NULL)
+		return 0;
+	copy_config_to(f, stack->configs, s->root);
+	return 1;
+}
+
+void dfs_clean(dfs_stack * stack)
+{
+	free(stack->configs);
+	free(stack->frames);
+	free(stack->sets);
+	free(stack->culprits);
+	free(stack->seen);
+	free(stack->queue);
+}
+
+// Bytes of a level of the stack
+size_t dfs_level_size(dfs_stack * stack)
+{
+	const formula * f = stack->s->f;
+	return f->cfg_size + sizeof (frame) + (stack->sets != NULL ? f->olconf_len * sizeof (bitstore) : 0);
+}
+
+bitstore * dfs_config(dfs_stack * stack, size_t level)
+{
+	return stack->configs + level * stack->s->f->cfg_len;
+}
+
+// Makes room for one more level, doubling the capacity when needed
+int dfs_reserve(dfs_stack * stack)
+{
+	size_t cfg_size = stack->s->f->cfg_size;
+
+	if (stack->depth + 1 < stack->capacity)
+		return 1;
+
+	size_t capacity = 2 * stack->capacity;
+	if (!within_memory(stack->s, capacity * dfs_level_size(stack)))
+		return 0;
+	bitstore * configs = realloc(stack->configs, capacity * cfg_size);
+	if (configs == NULL) return 0;
+	stack->configs = configs;
+
+	frame * frames = realloc(stack->frames, capacity * sizeof * frames);
+	if (frames == NULL) return 0;
+	stack->frames = frames;
+
+	if (stack->sets != NULL) {
+		bitstore * sets = realloc(stack->sets, capacity * stack->s->f->olconf_len * sizeof * sets);
+		if (sets == NULL) return 0;
+		stack->sets = sets;
+	}
+
+	stack->capacity = capacity;
+	return 1;
+}
+
+/* Pushes a decision on top of the current configuration.
+ * Fails when out of memory, leaving the stack as it is.
+ */
+int dfs_decide(dfs_stack * stack, int choice)
+{
+	solver * s = stack->s;
+
+	if (!dfs_reserve(stack)) {
+		if (s->stop_reason == NULL) s->stop_reason = "out of memory";
+		return 0;
+	}
+
+	bitstore * parent = dfs_config(stack, stack->depth);
+	bitstore * child = copy_config_to(s->f, parent + s->f->cfg_len, parent);
+
+	stack->frames[stack->depth].choice = choice;
+	stack->frames[stack->depth].flipped = 0;
+	stack->depth++;
+
+	if (s->proof != NULL) proof_enter(s->proof, stack->depth, choice);
+
+	lit_assign(s, child, choice);
+	return 1;
+}
+
+// Tries the other child of the node at the top, whose first one failed
+void dfs_flip(dfs_stack * stack)
+{
+	solver * s = stack->s;
+	frame * top = &stack->frames[stack->depth];
+
+	bitstore * parent = dfs_config(stack, stack->depth);
+	bitstore * child = copy_config_to(s->f, parent + s->f->cfg_len, parent);
+
+	top->flipped = 1;
+	stack->depth++;
+
+	if (s->proof != NULL) proof_enter(s->proof, stack->depth, -top->choice);
+
+	lit_assign(s, child, -top->choice);
+}
+
+/* Pops the exhausted levels, and flips the deepest decision
+ * that has not been flipped yet. Returns 0 when there is
+ * none left, that is, the whole search space is exhausted.
+ */
+int dfs_backtrack(dfs_stack * stack)
+{
+	solver * s = stack->s;
+
+	while (stack->depth > 0) {
+		frame * top = &stack->frames[--stack->depth];
+		if (top->flipped) {
+			// both children failed, so did the node
+			if (s->proof != NULL) proof_fail(s->proof, stack->depth);
+			continue;
+		}
+
+		dfs_flip(stack);
+		return 1;
+	}
+
+	return 0;
+}
+
+// Level the variable was assigned at, the first one it is assigned in
+size_t dfs_level(dfs_stack * stack, int var)
+{
+	const formula * f = stack->s->f;
+	size_t lo = 0, hi = stack->depth;
+
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+		bitstore * nconf = dfs_config(stack, mid) + f->cconf_len;
+		bitstore * pconf = nconf + f->olconf_len;
+		if (is_s_set(nconf, var) || is_s_set(pconf, var)) hi = mid;
+		else lo = mid + 1;
+	}
+
+	return lo;
+}
+
+// Queues the variables of a clause not followed yet
+size_t dfs_follow(dfs_stack * stack, int clause, size_t tail)
+{
+	const formula * f = stack->s->f;
+
+	for (int i = 0; i < f->olconf_len; i++)
+		for (bitstore w = (f->clauses[clause][i] | f->clauses[-clause][i]) & ~stack->seen[i]; w; w &= w - 1) {
+			int var = i * sbitstore + least_bit_pos(w);
+			s_set(stack->seen, var);
+			stack->queue[tail++] = var;
+		}
+
+	return tail;
+}
+
+/* Blames the conflict at the top on the levels of the decisions
+ * the clause the unit reductions found empty follows from. Literals
+ * implied other than by a clause, or a conflict with no clause found
+ * empty, of the XORs, cardinality constraints or components, blame
+ * every level up to theirs.
+ */
+void dfs_explain(dfs_stack * stack)
+{
+	solver * s = stack->s;
+	const formula * f = s->f;
+	size_t blamed = 0;
+	int conflict = s->conflict;
+
+	memset(stack->culprits, 0, f->olconf_len * sizeof * stack->culprits);
+	memset(stack->seen, 0, f->olconf_len * sizeof * stack->seen);
+
+	if (conflict == 0)
+		blamed = stack->depth;
+	else for (size_t head = 0, tail = dfs_follow(stack, conflict, 0); head < tail; head++) {
+		int var = stack->queue[head];
+		size_t level = dfs_level(stack, var);
+
+		if (level == 0) continue;
+		if (abs(stack->frames[level - 1].choice) == var)
+			s_set(stack->culprits, level);
+		else if (s->reasons[var] == 0)
+			blamed = (level > blamed) ? level : blamed;
+		else
+			tail = dfs_follow(stack, s->reasons[var], tail);
+	}
+
+	for (size_t level = 1; level <= blamed; level++)
+		s_set(stack->culprits, level);
+}
+
+/* Backtracks from a conflict over the levels it is not to blame
+ * on, those of them with a child yet to try as well, unless that
+ * is a jump of more than chrono levels. Returns 0 when there is
+ * no level left to flip, as dfs_backtrack does.
+ */
+int dfs_backjump(dfs_stack * stack)
+{
+	solver * s = stack->s;
+	size_t words = s->f->olconf_len;
+	bitstore * culprits = stack->culprits;
+
+	dfs_explain(stack);
+	int chrono = -1; // whether to, once the first level to jump over is found
+	int jumped = 0;
+
+	while (stack->depth > 0) {
+		size_t level = stack->depth;
+		frame * top = &stack->frames[--stack->depth];
+		bitstore * set = stack->sets + stack->depth * words;
+
+		if (!is_s_set(culprits, level)) {
+			// the node fails regardless of its decision
+			if (top->flipped) continue;
+			if (chrono < 0) {
+				size_t target = level;
+				while (target > 0 && !is_s_set(culprits, target)) target--;
+				chrono = s->chrono && level - target > s->chrono;
+			}
+			if (!chrono) {
+				stat_inc(s, jumped_levels);
+				jumped = 1;
+				continue;
+			}
+		}
+		else if (top->flipped) {
+			// both children failed, for the reasons of either one
+			s_clear(culprits, level);
+			for (size_t i = 0; i < words; i++)
+				culprits[i] |= set[i];
+			continue;
+		}
+
+		s_clear(culprits, level);
+		memcpy(set, culprits, words * sizeof * set);
+		if (jumped) stat_inc(s, backjumps);
+		dfs_flip(stack);
+		return 1;
+	}
+
+	if (jumped) stat_inc(s, backjumps);
+	return 0;
+}
+
+void dfs_checkpoint(dfs_stack * stack)
+{
+	FILE * fp = ckpt_begin(stack->s, DEPTH_FIRST, stack->depth);
+	if (fp == NULL) return;
+
+	fwrite(stack->frames, sizeof * stack->frames, stack->depth, fp);
+	fwrite(stack->configs, stack->s->f->cfg_size, stack->depth + 1, fp);
+	ckpt_end(stack->s, fp);
+}
+
+int dfs_resume(dfs_stack * stack)
+{
+	searcher kind;
+	uint64_t depth;
+	FILE * fp = ckpt_resume(stack->s, &kind, &depth);
+	if (fp == NULL) return 0;
+
+	stack->depth = 0;
+	while (stack->depth < depth)
+		if (stack->depth++, !dfs_reserve(stack)) {
+			fclose(fp);
+			return 0;
+		}
+
+	int ok =
+		fread(stack->frames, sizeof * stack->frames, depth, fp) == depth &&
+		fread(stack->configs, stack->s->f->cfg_size, depth + 1, fp) == depth + 1;
+	fclose(fp);
+
+	// the levels to blame are not saved, every one is blamed
+	if (stack->sets != NULL)
+		memset(stack->sets, 0xff, depth * stack->s->f->olconf_len * sizeof * stack->sets);
+
+	if (!ok) fputs("Checkpoint file is truncated.\n", stderr);
+	return ok;
+}
+
+int dfs_decompose(solver * s, bitstore * config, size_t held, dpll_result * result, bitstore ** model);
+
+/* Results in SUCCESS with a copy of the satisfying configuration
+ * put into model, FAIL if unsatisfiable, or TBD if stopped before
+ * finding out, in which case the search is checkpointed if asked.
+ * Every so many nodes, the node is split into its components if
+ * it has more than one, and each is searched on its own instead.
+ */
+dpll_result dpll_depth(solver * s, bitstore ** model)
+{
+	dfs_stack stack;
+	dpll_result result = TBD;
+	dpll_result split;
+	unsigned long long nodes = 0;
+
+	// the proof is of the whole tree of decisions, jumping over none
+	if (s->backjump && s->proof == NULL)
+		s->reasons = calloc(s->f->n_vars + 1, sizeof * s->reasons);
+
+	if (!dfs_init(s, &stack) || !within_memory(s, stack.capacity * dfs_level_size(&stack))) {
+		if (s->stop_reason == NULL) s->stop_reason = "out of memory";
+		dfs_clean(&stack);
+		free(s->reasons);
+		s->reasons = NULL;
+		return TBD;
+	}
+
+	if (s->resume_path != NULL && !dfs_resume(&stack)) {
+		dfs_clean(&stack);
+		free(s->reasons);
+		s->reasons = NULL;
+		return TBD;
+	}
+
+	s->ckpt_last = monotonic_sec();
+	if (s->proof != NULL) proof_enter(s->proof, 0, 0);
+
+	while (result == TBD) {
+		bitstore * config = dfs_config(&stack, stack.depth);
+		int choice;
+
+		if (should_stop(s)) {
+			if (s->ckpt_path != NULL)
+				dfs_checkpoint(&stack);
+			break;
+		}
+
+		if (ckpt_due(s))
+			dfs_checkpoint(&stack);
+		stats_progress(s);
+
+		switch (dpll_step(s, config)) {
+			case TBD:
+				// the proof knows nothing of the searches of the components
+				if (s->decompose && s->proof == NULL && nodes++ % s->decompose == 0
+					&& dfs_decompose(s, config, stack.capacity * dfs_level_size(&stack), &split, model)) {
+					if (split == SUCCESS) result = SUCCESS;
+					if (split != FAIL) break;
+					goto conflict;
+				}
+				choice = lit_choose(s, config);
+				if (choice != 0) {
+					s->n_decisions++;
+					prof_mark("decide", choice);
+					dfs_decide(&stack, choice);
+					stat_set(s, frontier, stack.depth);
+					break;
+				}
+#if DEBUG
+				puts("This shouldn't happen.");
+				sanity(s->f, config);
+#endif
+			case FAIL:
+			conflict:
+				s->n_conflicts++;
+				prof_mark("conflict", 0);
+				if (s->proof != NULL) proof_fail(s->proof, stack.depth);
+				if (!(stack.sets != NULL ? dfs_backjump(&stack) : dfs_backtrack(&stack)))
+					result = FAIL;
+				stat_set(s, frontier, stack.depth);
+				break;
+			case SUCCESS:
+				*model = copy_config(s->f, config);
+				result = SUCCESS;
+				break;
+		}
+	}
+
+	dfs_clean(&stack);
+	free(s->reasons);
+	s->reasons = NULL;
+	return result;
+}
+
+/* ==== Decomposition Functions ==== */
+/* A node of the depth-first search whose unsatisfied clauses fall
+ * into more than one component is satisfiable if and only if each
+ * of them is. Each component is then searched depth-first by a
+ * solver of its own, from the node with the clauses of the other
+ * components taken as satisfied, on as many threads as the solver
+ * tells. The first component found unsatisfiable stops the rest,
+ * and the models of all of them make up a model of the node.
+ * The searches of the components are not checkpointed, a search
+ * stopped in one of them resumes from the node split.
+ *
+ * The budget of the solver split is shared by its components: their
+ * decisions and conflicts are added up in the group as they go, up
+ * to the group of the solver the budget is of, and so are the bytes
+ * of their searchers, along with the stack of the solver split. The
+ * callback of the caller is polled under the lock of that group, one
+ * thread at a time.
+ */
+typedef struct component_group_tag component_group;
+
+struct component_job_tag {
+	solver sub;
+	dpll_result result;
+	bitstore * model;
+	component_group * group;
+	unsigned long long n_decisions;	// of the search of the component counted in the group
+	unsigned long long n_conflicts;
+	size_t held;					// bytes of its searcher counted in the group
+};
+
+struct component_group_tag {
+	solver * s;
+	const bitstore * config;	// the node split
+	const bitstore * rest;		// its unsatisfied clauses
+	bitstore * comps;			// clauses of each component, cconf_len words apart
+	component_job * jobs;
+	int n_jobs;
+	int next;					// job to be taken next
+	int failed;					// some component is unsatisfiable
+	unsigned long long n_decisions;	// of the solver split and its components so far
+	unsigned long long n_conflicts;
+	size_t held;				// bytes of the searchers of the solver split and its components
+	pthread_mutex_t lock;
+};
+
+/* Adds the decisions and conflicts of the search of the component
+ * to its group, and the groups of the splits above. Returns the
+ * reason to stop the search for, if the budget is spent.
+ */
+const char * component_count(component_job * job, unsigned long long decisions, unsigned long long conflicts)
+{
+	component_group * g = job->group;
+	const budget * limits = &g->s->limits;
+
+	pthread_mutex_lock(&g->lock);
+	job->n_decisions += decisions;
+	job->n_conflicts += conflicts;
+	g->n_decisions += decisions;
+	g->n_conflicts += conflicts;
+	const char * reason =
+		(limits->decisions && g->n_decisions >= limits->decisions) ? "decision limit" :
+		(limits->conflicts && g->n_conflicts >= limits->conflicts) ? "conflict limit" : NULL;
+	pthread_mutex_unlock(&g->lock);
+
+	return (g->s->job != NULL) ? component_count(g->s->job, decisions, conflicts) : reason;
+}
+
+/* Tells whether the searcher of the component may grow to the size
+ * given, along with the rest of the group, and the groups above.
+ * Shrinking is counted either way.
+ */
+int component_within(component_job * job, size_t searcher_size)
+{
+	component_group * g = job->group;
+
+	pthread_mutex_lock(&g->lock);
+	size_t held = g->held - job->held + searcher_size;
+	int ok = (g->s->job != NULL) ? component_within(g->s->job, held) :
+		formula_size(g->s->f) + held <= g->s->limits.memory;
+	if (ok || searcher_size <= job->held) {
+		g->held = held;
+		job->held = searcher_size;
+	}
+	pthread_mutex_unlock(&g->lock);
+
+	return ok;
+}
+
+/* Components stop when one of them fails, when the budget is spent,
+ * or when the solver split would. Sets the reason of the stop unless
+ * it is another component failing.
+ */
+int component_stop(void * data)
+{
+	component_job * job = data;
+	component_group * g = job->group;
+	solver * sub = &job->sub;
+
+	const char * reason = component_count(job, sub->n_decisions - job->n_decisions, sub->n_conflicts - job->n_conflicts);
+	if (reason != NULL && sub->stop_reason == NULL)
+		sub->stop_reason = reason;
+
+	pthread_mutex_lock(&g->lock);
+	int stop = g->failed || reason != NULL ||
+		(g->s->terminate != NULL && g->s->terminate(g->s->terminate_data));
+	pthread_mutex_unlock(&g->lock);
+
+	return stop;
+}
+
+void component_setup(component_group * g, int k)
+{
+	solver * s = g->s;
+	const formula * f = s->f;
+	solver * sub = &g->jobs[k].sub;
+	const bitstore * comp = g->comps + k * f->cconf_len;
+
+	// XORs are left out, those of the other components would be broken by their clauses taken as satisfied
+	solver_init(sub, f);
+	sub->depth_first = 1;
+	sub->decompose = s->decompose;
+	sub->backjump = s->backjump;
+	sub->chrono = s->chrono;
+	sub->threads = 1;
+	sub->limits = s->limits;
+	sub->limits.decisions = sub->limits.conflicts = 0; // counted in the group
+	sub->terminate = component_stop;
+	sub->terminate_data = &g->jobs[k];
+	sub->job = &g->jobs[k];
+	sub->search_start = s->search_start;
+
+	sub->root = copy_config(f, (bitstore *) g->config);
+	for (int i = 0; i < f->cconf_len; i++)
+		sub->root[i] |= g->rest[i] & ~comp[i];
+}
+
+void * component_worker(void * arg)
+{
+	component_group * g = arg;
+
+	for (;;) {
+		pthread_mutex_lock(&g->lock);
+		int k = g->next++;
+		int failed = g->failed;
+		pthread_mutex_unlock(&g->lock);
+		if (k >= g->n_jobs || failed) break;
+
+		component_job * job = &g->jobs[k];
+		component_setup(g, k);
+		job->result = dpll_depth(&job->sub, &job->model);
+		component_within(job, 0); // its searcher is freed
+
+		if (job->result == FAIL) {
+			pthread_mutex_lock(&g->lock);
+			g->failed = 1;
+			pthread_mutex_unlock(&g->lock);
+		}
+	}
+
+	return NULL;
+}
+
+// Puts the model of each component over the node, into a model of the node
+bitstore * component_merge(component_group * g)
+{
+	const formula * f = g->s->f;
+	bitstore * model = copy_config(f, (bitstore *) g->config);
+	bitstore * nconf = model + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+	bitstore * vars = malloc(f->olconf_len * sizeof * vars);
+
+	for (int k = 0; k < g->n_jobs; k++) {
+		bitstore * sub_nconf = g->jobs[k].model + f->cconf_len;
+		bitstore * sub_pconf = sub_nconf + f->olconf_len;
+
+		clause_vars(f, g->config, g->comps + k * f->cconf_len, vars);
+		for (int j = 0; j < f->olconf_len; j++) {
+			nconf[j] = (nconf[j] & ~vars[j]) | (sub_nconf[j] & vars[j]);
+			pconf[j] = (pconf[j] & ~vars[j]) | (sub_pconf[j] & vars[j]);
+		}
+	}
+	for (int i = 0; i < f->cconf_len; i++)
+		model[i] |= g->rest[i];
+
+	free(vars);
+	return model;
+}
+
+/* Splits the node into its components and searches each, unless
+ * there is only one, the searcher of the solver holding the bytes
+ * given. Returns 0 if not split, otherwise 1 with the result of the
+ * node in result, and its model in model if SUCCESS.
+ */
+int dfs_decompose(solver * s, bitstore * config, size_t held, dpll_result * result, bitstore ** model)
+{
+	const formula * f = s->f;
+	if (f->n_cards > 0) return 0; // the constraints tie the components together
+	bitstore * rest = malloc(f->cconf_len * sizeof * rest);
+	bitstore * vars = malloc(f->olconf_len * sizeof * vars);
+	bitstore * comps = NULL;
+	int n_comps = 0;
+
+	unsat_clauses(f, config, rest);
+	bitstore * left = memcpy(malloc(f->cconf_len * sizeof * left), rest, f->cconf_len * sizeof * left);
+
+	for (int i = 0; i < f->cconf_len; i++)
+		while (left[i]) {
+			int c = i * sbitstore + least_bit_pos(left[i]);
+			comps = realloc(comps, (n_comps + 1) * f->cconf_len * sizeof * comps);
+			bitstore * comp = comps + n_comps++ * f->cconf_len;
+			component_grow(f, config, left, c, comp, vars);
+			for (int k = 0; k < f->cconf_len; k++)
+				left[k] &= ~comp[k];
+		}
+
+	free(left);
+	free(vars);
+	if (n_comps < 2) {
+		free(rest);
+		free(comps);
+		return 0;
+	}
+
+	stat_inc(s, splits);
+#ifdef STATS
+	s->stats.split_components += n_comps;
+#endif
+
+	component_group g = { s, config, rest, comps };
+	g.jobs = calloc(n_comps, sizeof * g.jobs);
+	g.n_jobs = n_comps;
+	g.n_decisions = s->n_decisions;
+	g.n_conflicts = s->n_conflicts;
+	g.held = held;
+	for (int k = 0; k < n_comps; k++)
+		g.jobs[k].group = &g;
+	pthread_mutex_init(&g.lock, NULL);
+
+	int n_threads = (s->threads < n_comps) ? s->threads : n_comps;
+	pthread_t * threads = malloc(n_threads * sizeof * threads);
+	for (int t = 1; t < n_threads; t++)
+		pthread_create(&threads[t], NULL, component_worker, &g);
+	component_worker(&g);
+	for (int t = 1; t < n_threads; t++)
+		pthread_join(threads[t], NULL);
+	free(threads);
+	pthread_mutex_destroy(&g.lock);
+
+	// the solver split holds its own searcher alone again
+	if (s->job != NULL)
+		component_within(s->job, held);
+
+	int solved = 0;
+	for (int k = 0; k < n_comps; k++) {
+		component_job * job = &g.jobs[k];
+		solved += job->result == SUCCESS;
+		s->n_decisions += job->sub.n_decisions;
+		s->n_conflicts += job->sub.n_conflicts;
+#ifdef STATS
+		s->stats.propagations += job->sub.stats.propagations;
+		s->stats.pure_literals += job->sub.stats.pure_literals;
+		s->stats.splits += job->sub.stats.splits;
+		s->stats.split_components += job->sub.stats.split_components;
+		s->stats.backjumps += job->sub.stats.backjumps;
+		s->stats.jumped_levels += job->sub.stats.jumped_levels;
+#endif
+		// the reason of the first one stopped on its own, not by another's failure
+		if (!g.failed && job->sub.stop_reason != NULL && s->stop_reason == NULL)
+			s->stop_reason = job->sub.stop_reason;
+	}
+
+	if (g.failed)
+		*result = FAIL;
+	else if (solved == n_comps) {
+		*model = component_merge(&g);
+		*result = SUCCESS;
+	}
+	else
+		*result = TBD;
+
+	for (int k = 0; k < n_comps; k++) {
+		free(g.jobs[k].model);
+		solver_clean(&g.jobs[k].sub);
+	}
+	free(g.jobs);
+	free(comps);
+	free(rest);
+	return 1;
+}
+
+// Saves the TBD configurations of the frontier, the rest are of no use
+void breadth_checkpoint(solver * s, bitstore * prealloc, dpll_result * results, int last)
+{
+	int count = 0;
+	for (int i = 0; i < last; i++)
+		count += results[i] == TBD;
+
+	FILE * fp = ckpt_begin(s, BREADTH_FIRST, count);
+	if (fp == NULL) return;
+
+	for (int i = 0; i < last; i++) if (results[i] == TBD)
+		fwrite(prealloc + i * s->f->cfg_len, s->f->cfg_size, 1, fp);
+	ckpt_end(s, fp);
+}
+
+/* Loads the frontier from the checkpoint, growing the buffers
+ * to fit it. Returns the number of configurations loaded.
+ */
+int breadth_resume(solver * s, bitstore ** prealloc, dpll_result ** results, size_t * length)
+{
+	size_t cfg_size = s->f->cfg_size;
+	searcher kind;
+	uint64_t count;
+	FILE * fp = ckpt_resume(s, &kind, &count);
+	if (fp == NULL) return 0;
+
+	while (*length <= 2 * count) *length *= 2;
+	bitstore * p = realloc(*prealloc, *length * cfg_size);
+	dpll_result * r = realloc(*results, *length * sizeof * r);
+	if (p != NULL) *prealloc = p;
+	if (r != NULL) *results = r;
+
+	int ok = p != NULL && r != NULL && fread(p, cfg_size, count, fp) == count;
+	fclose(fp);
+
+	if (!ok) {
+		fputs("Checkpoint couldn't be loaded.\n", stderr);
+		return 0;
+	}
+
+	for (int i = 0; i < count; i++) r[i] = TBD;
+	return count;
+}
+
+/* Breadth-first SAT solver, uses more memory
+ * but takes less time, whenever the problem is SAT.
+ * Results the same way dpll_depth does.
+ */
+dpll_result dpll_breadth(solver * s, bitstore ** model)
+{
+	const formula * f = s->f;
+	size_t cfg_len = f->cfg_len;
+	size_t cfg_size = f->cfg_size;
+	size_t length = (1ULL << 18) / cfg_size;
+	bitstore * prealloc = malloc(length * cfg_size);
+	dpll_result * results = malloc(length * sizeof * results);
+
+	if (prealloc == NULL || results == NULL
+		|| !within_memory(s, length * (cfg_size + sizeof * results))) {
+		if (s->stop_reason == NULL) s->stop_reason = "out of memory";
+		free(prealloc);
+		free(results);
+		return TBD;
+	}
+
+	copy_config_to(f, prealloc, s->root);
+	results[0] = TBD;
+
+	int nTBD = 1;
+	int last = 1;
+
+	if (s->resume_path != NULL) {
+		nTBD = last = breadth_resume(s, &prealloc, &results, &length);
+		if (last == 0) {
+			free(prealloc);
+			free(results);
+			return TBD;
+		}
+	}
+
+	s->ckpt_last = monotonic_sec();
+
+	// continue until all become FAILs and one becomes SUCCESS
+	// last will remain the same, if all none turned out TBD or SUCCESS
+	while (nTBD) {
+		if (nTBD < last / 2 || last > length / 2) {
+#if DEBUG
+			int old_last = last;
+#endif
+			last--;
+			for (int i = 0; i <= last; i++) if (results[i] == FAIL) {
+				memcpy(prealloc + i * cfg_len, prealloc + last-- * cfg_len, cfg_size);
+				results[i] = TBD; // we know it's not FAIL nor SUCCESS
+				while (results[last] == FAIL) last--;
+			}
+			last++;
+			stat_inc(s, consolidations);
+#if DEBUG
+			printf("Consolidation by %.2f%%\n", 100.0 * last / old_last);
+#endif
+		}
+		if (last > length / 2 && within_memory(s, 2 * length * (cfg_size + sizeof * results))) {
+			bitstore * p = realloc(prealloc, 2 * length * cfg_size);
+			dpll_result * r = realloc(results, 2 * length * sizeof * results);
+			if (p != NULL) prealloc = p;
+			if (r != NULL) results = r;
+#if DEBUG
+			printf("size increase!\n");
+#endif
+			if (p == NULL || r == NULL)
+				s->stop_reason = "out of memory";
+			else
+				length *= 2;
+		}
+
+		nTBD = 0;
+
+		for (int i = last - 1; i >= 0; i--) if (results[i] == TBD) {
+			// both the visited and the unvisited TBDs are pending a step
+			if (should_stop(s) || last >= length) {
+				if (s->ckpt_path != NULL)
+					breadth_checkpoint(s, prealloc, results, last);
+				free(prealloc);
+				free(results);
+				return TBD;
+			}
+
+			if (ckpt_due(s))
+				breadth_checkpoint(s, prealloc, results, last);
+			stats_progress(s);
+
+			bitstore * exhibit = prealloc + i * cfg_len;
+			bitstore * exhibitA;
+			bitstore * exhibitB;
+			int choice;
+
+			switch (results[i] = dpll_step(s, exhibit)) {
+				case TBD:
+					choice = lit_choose(s, exhibit);
+					if (choice != 0) {
+						exhibitA = exhibit;
+						exhibitB = copy_config_to(f, prealloc + last * cfg_len, exhibit);
+
+						lit_assign(s, exhibitA, choice);
+						lit_assign(s, exhibitB, -choice);
+
+						results[last++] = TBD;
+						nTBD += 2;
+						s->n_decisions++;
+						prof_mark("decide", choice);
+						stat_set(s, frontier, last);
+
+						break;
+					}
+
+					results[i] = FAIL;
+					puts("This shouldn't happen.");
+				case FAIL:
+					s->n_conflicts++;
+					prof_mark("conflict", 0);
+					break;
+				case SUCCESS:
+					*model = copy_config(f, exhibit);
+					free(prealloc);
+					free(results);
+					return SUCCESS;
+			}
+		}
+	}
+
+	free(prealloc);
+	free(results);
+	return FAIL;
+}
+
+/* Tells which searcher took the checkpoint, or -1 if it cannot
+ * be resumed, so that a bad one is rejected before searching.
+ */
+int ckpt_probe(solver * s)
+{
+	searcher kind;
+	uint64_t count;
+	FILE * fp = ckpt_resume(s, &kind, &count);
+	if (fp == NULL) return -1;
+
+	long expected = sizeof (ckpt_header) + (kind == BREADTH_FIRST
+		? count * s->f->cfg_size
+		: count * sizeof (frame) + (count + 1) * s->f->cfg_size);
+	fseek(fp, 0, SEEK_END);
+	long actual = ftell(fp);
+	fclose(fp);
+
+	if (actual != expected) {
+		fputs("Checkpoint file is truncated.\n", stderr);
+		return -1;
+	}
+
+	return kind;
+}
+
+/* ==== Bit-sliced Evaluation Functions ==== */
+/* Complete assignments are evaluated 64 at a time, in lanes:
+ * each variable has a word, whose bit j is its value in the
+ * j-th assignment. A clause is then satisfied in the lanes
+ * of the OR of its literals' words, negated ones complemented,
+ * and counts of satisfied clauses are kept bit-sliced too, in
+ * planes: bit j of plane p is bit p of the count of lane j, so
+ * that adding a clause to all 64 counts is a ripple of carries.
+ * These make random probing, and the initial assignments of
+ * local search, 64 assignments wide at the cost of one.
+ */
+#define N_LANES 64
+
+uint64_t splitmix64(uint64_t * state)
+{
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+// Planes it takes to count up to every clause
+int lanes_planes(const formula * f)
+{
+	int n = 1;
+	while (n < 32 && (1U << n) <= f->n_clauses) n++;
+	return n;
+}
+
+// Random values in each lane, but the assumed ones, the same in all
+void lanes_random(const formula * f, uint64_t * rng, const int * assumptions, size_t n, uint64_t * values)
+{
+	values[0] = 0;
+	for (int var = 1; var <= f->n_vars; var++)
+		values[var] = splitmix64(rng);
+
+	for (size_t i = 0; i < n; i++) {
+		int var = abs(assumptions[i]);
+		if (var == 0 || var > f->n_vars) continue;
+		values[var] = (assumptions[i] > 0) ? ~0ULL : 0;
+	}
+}
+
+/* Evaluates the clauses in every lane, in a single pass over the
+ * flat literal array. Returns the lanes satisfying all of them,
+ * leaving the counts of satisfied clauses in planes.
+ */
+uint64_t lanes_eval(const formula * f, const uint64_t * values, uint64_t * planes, int n_planes)
+{
+	uint64_t all = ~0ULL;
+	uint64_t sat = 0;
+
+	memset(planes, 0, n_planes * sizeof * planes);
+	for (size_t i = 0; i < f->lits_len; i++) {
+		int lit = f->lits[i];
+		if (lit != 0) {
+			sat |= values[abs(lit)] ^ -(uint64_t) (lit < 0);
+			continue;
+		}
+
+		all &= sat;
+		for (int p = 0; sat && p < n_planes; p++) {
+			uint64_t carry = planes[p] & sat;
+			planes[p] ^= sat;
+			sat = carry;
+		}
+		sat = 0;
+	}
+
+	return all;
+}
+
+void lanes_counts(const uint64_t * planes, int n_planes, unsigned int * counts)
+{
+	for (int lane = 0; lane < N_LANES; lane++) {
+		counts[lane] = 0;
+		for (int p = 0; p < n_planes; p++)
+			counts[lane] |= (unsigned int) (planes[p] >> lane & 1) << p;
+	}
+}
+
+// Lane satisfying the most clauses, compared plane by plane from the top
+int lanes_best(const uint64_t * planes, int n_planes)
+{
+	uint64_t best = ~0ULL;
+
+	for (int p = n_planes - 1; p >= 0; p--)
+		if (best & planes[p])
+			best &= planes[p];
+
+	return __builtin_ctzll(best);
+}
+
+// Values of a lane, one per variable
+void lanes_extract(const formula * f, const uint64_t * values, int lane, signed char * value)
+{
+	for (int var = 1; var <= f->n_vars; var++)
+		value[var] = values[var] >> lane & 1;
+}
+
+// Satisfying configuration of a complete assignment
+bitstore * model_config(const formula * f, const signed char * value)
+{
+	bitstore * config = calloc(f->cfg_len, sizeof * config);
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+
+	for (int c = 1; c <= f->n_clauses; c++)
+		s_set(config, c);
+	for (int var = 1; var <= f->n_vars; var++) {
+		if (value[var]) s_set(pconf, var);
+		else            s_set(nconf, var);
+	}
+
+	return config;
+}
+
+/* Tries probes rounds of 64 random assignments before searching,
+ * results in SUCCESS with the first one satisfying, TBD otherwise.
+ */
+dpll_result lanes_probe(solver * s, const int * assumptions, size_t n, bitstore ** model)
+{
+	// the lanes are evaluated against the clauses alone
+	if (s->probes == 0 || s->f->n_cards > 0) return TBD;
+
+	const formula * f = s->f;
+	int n_planes = lanes_planes(f);
+	uint64_t * values = malloc((f->n_vars + 1) * sizeof * values);
+	uint64_t * planes = malloc(n_planes * sizeof * planes);
+	uint64_t rng = s->seed;
+	dpll_result result = TBD;
+
+	for (unsigned int round = 0; round < s->probes && !should_stop(s); round++) {
+		lanes_random(f, &rng, assumptions, n, values);
+		uint64_t all = lanes_eval(f, values, planes, n_planes);
+		if (all) {
+			signed char * value = malloc(f->n_vars + 1);
+			lanes_extract(f, values, __builtin_ctzll(all), value);
+			*model = model_config(f, value);
+			free(value);
+			result = SUCCESS;
+			break;
+		}
+	}
+
+	free(values);
+	free(planes);
+	return result;
+}
+
+/* ==== Local Search Functions ==== */
+/* Stochastic local search, flipping variables of a complete
+ * assignment until it satisfies every clause. Occurrences of
+ * each literal are listed from the occurrence bitmaps once,
+ * and each clause keeps its number of true literals along with
+ * the XOR of their variables, which is the critical variable
+ * whenever there is only one of them. Break counts, the clauses
+ * flipping a variable would leave unsatisfied, are kept up to
+ * date by each flip, as is the list of unsatisfied clauses with
+ * the position of each clause in it.
+ * Tautologies are left out, being satisfied by any assignment.
+ * Variables of the assumptions are fixed, never flipped.
+ * Search starts from the best of 64 random assignments.
+ */
+#define SLS_POLL_FLIPS 1024		// flips in between polls of the budgets
+
+typedef
+struct sls_state_tag {
+	const formula * f;
+	int * occ_offs;			// where the occurrences of each literal start in occ,
+	int * occ;				// offset by n_vars so that negatives index too
+	signed char * value;	// 1 or 0 for each variable
+	char * fixed;			// by the assumptions
+	int * breaks;
+	int * n_true;			// true literals of each clause
+	int * crit;				// XOR of the variables of those
+	int * unsat;			// unsatisfied clauses
+	int * unsat_pos;		// position of each clause in unsat
+	int n_unsat;
+	double probs[64];		// of probSAT, by break count
+	uint64_t rng;
+} sls_state;
+
+uint64_t sls_next(sls_state * st)
+{
+	return splitmix64(&st->rng);
+}
+
+double sls_uniform(sls_state * st)
+{
+	return (sls_next(st) >> 11) * 0x1.0p-53;
+}
+
+void sls_unsat_add(sls_state * st, int c)
+{
+	st->unsat_pos[c] = st->n_unsat;
+	st->unsat[st->n_unsat++] = c;
+}
+
+void sls_unsat_remove(sls_state * st, int c)
+{
+	int last = st->unsat[--st->n_unsat];
+	st->unsat[st->unsat_pos[c]] = last;
+	st->unsat_pos[last] = st->unsat_pos[c];
+}
+
+int is_tautology(const formula * f, int c)
+{
+	for (int i = 0; i < f->olconf_len; i++)
+		if (f->clauses[c][i] & f->clauses[-c][i])
+			return 1;
+	return 0;
+}
+
+// Lists the clauses of each literal, out of the occurrence bitmaps
+void sls_occurrences(sls_state * st)
+{
+	const formula * f = st->f;
+	char * taut = malloc(f->n_clauses + 1);
+	int n = 0;
+
+	for (int c = 1; c <= f->n_clauses; c++)
+		taut[c] = is_tautology(f, c);
+
+	st->occ_offs = malloc((2 * f->n_vars + 2) * sizeof * st->occ_offs);
+	st->occ = malloc((f->n_lits + 1) * sizeof * st->occ);
+
+	for (int lit = -(int) f->n_vars; lit <= (int) f->n_vars; lit++) {
+		st->occ_offs[lit + f->n_vars] = n;
+		if (lit == 0) continue;
+
+		bitstore * occurlist = f->occurlists[lit];
+		for (int i = 0; i < f->cconf_len; i++) {
+			bitstore occ = occurlist[i];
+			while (occ) {
+				int pos = least_bit_pos(occ);
+				int c = i * sbitstore + pos;
+				if (!taut[c]) st->occ[n++] = c;
+				occ &= ~bit(pos);
+			}
+		}
+	}
+	st->occ_offs[2 * f->n_vars + 1] = n;
+
+	free(taut);
+}
+
+/* probSAT is the best known with break only, and exponential
+ * probabilities, with a base growing with the clause length.
+ */
+void sls_probs(sls_state * st)
+{
+	const formula * f = st->f;
+	int k = 0, len = 0;
+
+	for (size_t i = 0; i < f->lits_len; i++) {
+		if (f->lits[i]) len++;
+		else {
+			if (len > k) k = len;
+			len = 0;
+		}
+	}
+
+	double cb = (k <= 3) ? 2.5 : (k == 4) ? 3.0 : (k == 5) ? 3.7 : (k == 6) ? 5.1 : 5.4;
+	st->probs[0] = 1;
+	for (int b = 1; b < 64; b++)
+		st->probs[b] = st->probs[b - 1] / cb;
+}
+
+// Sets up the starting assignment, and its counts
+int sls_init(sls_state * st, solver * s, const int * assumptions, size_t n)
+{
+	const formula * f = s->f;
+
+	memset(st, 0, sizeof * st);
+	st->f = f;
+	st->rng = s->seed;
+	sls_occurrences(st);
+	sls_probs(st);
+
+	st->value = malloc(f->n_vars + 1);
+	st->fixed = calloc(f->n_vars + 1, 1);
+	st->breaks = calloc(f->n_vars + 1, sizeof * st->breaks);
+	st->n_true = calloc(f->n_clauses + 1, sizeof * st->n_true);
+	st->crit = calloc(f->n_clauses + 1, sizeof * st->crit);
+	st->unsat = malloc((f->n_clauses + 1) * sizeof * st->unsat);
+	st->unsat_pos = malloc((f->n_clauses + 1) * sizeof * st->unsat_pos);
+
+	int n_planes = lanes_planes(f);
+	uint64_t * values = malloc((f->n_vars + 1) * sizeof * values);
+	uint64_t * planes = malloc(n_planes * sizeof * planes);
+	lanes_random(f, &st->rng, assumptions, n, values);
+	lanes_eval(f, values, planes, n_planes);
+	lanes_extract(f, values, lanes_best(planes, n_planes), st->value);
+	free(values);
+	free(planes);
+
+	for (size_t i = 0; i < n; i++) {
+		int var = abs(assumptions[i]);
+		if (var == 0 || var > f->n_vars) continue;
+		if (st->fixed[var] && st->value[var] != (assumptions[i] > 0))
+			return 0; // assumed both ways
+		st->fixed[var] = 1;
+		st->value[var] = assumptions[i] > 0;
+	}
+
+	for (int var = 1; var <= f->n_vars; var++) {
+		int lit = st->value[var] ? var : -var;
+		for (int i = st->occ_offs[lit + f->n_vars]; i < st->occ_offs[lit + f->n_vars + 1]; i++) {
+			int c = st->occ[i];
+			st->n_true[c]++;
+			st->crit[c] ^= var;
+		}
+	}
+
+	for (int c = 1; c <= f->n_clauses; c++) {
+		if (st->n_true[c] == 0 && !is_tautology(f, c))
+			sls_unsat_add(st, c);
+		else if (st->n_true[c] == 1)
+			st->breaks[st->crit[c]]++;
+	}
+
+	return 1;
+}
+
+void sls_clean(sls_state * st)
+{
+	free(st->occ_offs);
+	free(st->occ);
+	free(st->value);
+	free(st->fixed);
+	free(st->breaks);
+	free(st->n_true);
+	free(st->crit);
+	free(st->unsat);
+	free(st->unsat_pos);
+}
+
+void sls_flip(sls_state * st, int var)
+{
+	int n_vars = st->f->n_vars;
+	int lit = st->value[var] ? -var : var; // the one becoming true
+
+	st->value[var] ^= 1;
+
+	for (int i = st->occ_offs[lit + n_vars]; i < st->occ_offs[lit + n_vars + 1]; i++) {
+		int c = st->occ[i];
+		switch (++st->n_true[c]) {
+			case 1:
+				sls_unsat_remove(st, c);
+				st->breaks[var]++;
+				break;
+			case 2:
+				st->breaks[st->crit[c]]--;
+				break;
+		}
+		st->crit[c] ^= var;
+	}
+
+	for (int i = st->occ_offs[-lit + n_vars]; i < st->occ_offs[-lit + n_vars + 1]; i++) {
+		int c = st->occ[i];
+		st->crit[c] ^= var;
+		switch (--st->n_true[c]) {
+			case 0:
+				sls_unsat_add(st, c);
+				st->breaks[var]--;
+				break;
+			case 1:
+				st->breaks[st->crit[c]]++;
+				break;
+		}
+	}
+}
+
+// Variable of a clause to flip, 0 if all of them are fixed
+int sls_pick(sls_state * st, local_search algo, int c)
+{
+	const int * lits = st->f->lits + st->f->clause_offs[c];
+	double sum = 0;
+	int best = 0, n_free = 0;
+
+	for (int i = 0; lits[i]; i++) {
+		int var = abs(lits[i]);
+		if (st->fixed[var]) continue;
+		n_free++;
+
+		int b = st->breaks[var];
+		if (algo == SLS_PROBSAT)
+			sum += st->probs[b < 64 ? b : 63];
+		else if (best == 0 || b < st->breaks[best])
+			best = var;
+	}
+	if (n_free == 0) return 0;
+
+	// WalkSAT flips a variable breaking nothing, if any, else a random one with p = 0.567
+	if (algo == SLS_WALKSAT && (st->breaks[best] == 0 || sls_uniform(st) >= 0.567))
+		return best;
+
+	double r = (algo == SLS_PROBSAT) ? sls_uniform(st) * sum : sls_next(st) % n_free;
+	for (int i = 0; lits[i]; i++) {
+		int var = abs(lits[i]);
+		if (st->fixed[var]) continue;
+
+		int b = st->breaks[var];
+		r -= (algo == SLS_PROBSAT) ? st->probs[b < 64 ? b : 63] : 1;
+		if (r < 0) return var;
+	}
+	return best ? best : abs(lits[0]); // rounding left r at 0
+}
+
+/* Results in SUCCESS with the model put into a configuration,
+ * FAIL if the assumptions leave a clause unsatisfiable, or TBD
+ * if the budgets run out first.
+ */
+dpll_result sls_solve(solver * s, const int * assumptions, size_t n, bitstore ** model)
+{
+	const formula * f = s->f;
+	dpll_result result = TBD;
+	sls_state st;
+
+	if (f->n_cards > 0) {
+		s->stop_reason = "local search takes no cardinality constraints";
+		return TBD;
+	}
+
+	for (int c = 1; c <= f->n_clauses; c++)
+		if (f->lits[f->clause_offs[c]] == 0)
+			return FAIL; // an empty clause
+
+	if (!sls_init(&st, s, assumptions, n)) {
+		sls_clean(&st);
+		return FAIL;
+	}
+
+	while (result == TBD) {
+		if (st.n_unsat == 0) {
+			result = SUCCESS;
+			break;
+		}
+
+		if (s->n_flips % SLS_POLL_FLIPS == 0 || s->n_flips == s->limits.flips) {
+			stat_set(s, frontier, st.n_unsat);
+			if (should_stop(s)) break;
+			stats_progress(s);
+		}
+
+		int c = st.unsat[sls_next(&st) % st.n_unsat];
+		int var = sls_pick(&st, s->sls, c);
+		if (var == 0) {
+			result = FAIL; // falsified by the assumptions alone
+			break;
+		}
+
+		sls_flip(&st, var);
+		s->n_flips++;
+	}
+
+	if (result == SUCCESS)
+		*model = model_config(f, st.value);
+
+	sls_clean(&st);
+	return result;
+}
+
+/* ==== Bignum Functions ==== */
+/* Unsigned integers of any size, in 32-bit limbs from the
+ * least significant one, as model counts overflow any word.
+ */
+void bignum_init(bignum * a)
+{
+	a->limbs = NULL;
+	a->len = a->cap = 0;
+}
+
+void bignum_free(bignum * a)
+{
+	free(a->limbs);
+	bignum_init(a);
+}
+
+void bignum_reserve(bignum * a, size_t cap)
+{
+	if (cap <= a->cap) return;
+	a->limbs = realloc(a->limbs, cap * sizeof * a->limbs);
+	a->cap = cap;
+}
+
+void bignum_trim(bignum * a)
+{
+	while (a->len > 0 && a->limbs[a->len - 1] == 0) a->len--;
+}
+
+void bignum_set_pow2(bignum * a, size_t k)
+{
+	bignum_reserve(a, k / 32 + 1);
+	a->len = k / 32 + 1;
+	memset(a->limbs, 0, a->len * sizeof * a->limbs);
+	a->limbs[k / 32] = 1U << (k % 32);
+}
+
+void bignum_copy(bignum * a, const bignum * b)
+{
+	bignum_reserve(a, b->len);
+	if (b->len) memcpy(a->limbs, b->limbs, b->len * sizeof * a->limbs);
+	a->len = b->len;
+}
+
+// a += b
+void bignum_add(bignum * a, const bignum * b)
+{
+	size_t len = (a->len > b->len) ? a->len : b->len;
+	uint64_t carry = 0;
+
+	bignum_reserve(a, len + 1);
+	for (size_t i = 0; i < len; i++) {
+		uint64_t sum = carry
+			+ (i < a->len ? a->limbs[i] : 0)
+			+ (i < b->len ? b->limbs[i] : 0);
+		a->limbs[i] = (uint32_t) sum;
+		carry = sum >> 32;
+	}
+	a->limbs[len] = (uint32_t) carry;
+	a->len = len + 1;
+	bignum_trim(a);
+}
+
+// a *= b
+void bignum_mul(bignum * a, const bignum * b)
+{
+	size_t len = a->len + b->len;
+	uint32_t * product = calloc(len + 1, sizeof * product);
+
+	for (size_t i = 0; i < a->len; i++) {
+		uint64_t carry = 0;
+		for (size_t j = 0; j < b->len; j++) {
+			uint64_t t = (uint64_t) a->limbs[i] * b->limbs[j] + product[i + j] + carry;
+			product[i + j] = (uint32_t) t;
+			carry = t >> 32;
+		}
+		product[i + b->len] = (uint32_t) carry;
+	}
+
+	free(a->limbs);
+	a->limbs = product;
+	a->len = len;
+	a->cap = len + 1;
+	bignum_trim(a);
+}
+
+// Decimal digits, to be freed
+char * bignum_str(const bignum * a)
+{
+	size_t len = a->len;
+	uint32_t * n = malloc((len + 1) * sizeof * n);
+	char * str = malloc(10 * len + 2);
+	char * p = str + 10 * len + 1;
+
+	memcpy(n, a->limbs, len * sizeof * n);
+	*p = '\0';
+	do {
+		// divides by 10^9, leaving the remainder as the next nine digits
+		uint64_t rem = 0;
+		for (size_t i = len; i-- > 0; ) {
+			uint64_t cur = rem << 32 | n[i];
+			n[i] = (uint32_t) (cur / 1000000000);
+			rem = cur % 1000000000;
+		}
+		while (len > 0 && n[len - 1] == 0) len--;
+
+		for (int d = 0; d < 9 && (len > 0 || rem > 0 || d == 0); d++) {
+			*--p = '0' + rem % 10;
+			rem /= 10;
+		}
+	} while (len > 0);
+
+	free(n);
+	memmove(str, p, strlen(p) + 1);
+	return str;
+}
+
+/* ==== Model Counting Functions ==== */
+/* Counts the models by DPLL, with unit propagation but no pure
+ * literals, as those would leave out the models with their other
+ * value. At each node, the unsatisfied clauses left are split into
+ * connected components, sharing no unassigned variables, counted on
+ * their own and multiplied together, and by 2 for each variable no
+ * longer in any clause. A component is the set of its clauses and
+ * of its unassigned variables, which tells the residual formula
+ * exactly, so counts of components are cached by those sets, with
+ * the least recently used ones evicted beyond the size of the cache.
+ * Nodes are kept on an explicit stack of levels, as the depth-first
+ * searcher keeps them, a level per decision, as deep as the variables
+ * at most, each with its configuration, the component it is counting
+ * and the partial product of its own components.
+ */
+#define COUNT_CACHE_SIZE (256ULL << 20)	// bytes, unless the solver tells
+
+typedef
+struct cache_entry_tag {
+	uint64_t hash;
+	int * key;				// clauses, then a 0, then variables
+	size_t key_len;
+	bignum count;
+	struct cache_entry_tag * next;		// in the bucket
+	struct cache_entry_tag * newer;		// in the LRU order
+	struct cache_entry_tag * older;
+} cache_entry;
+
+typedef
+struct count_cache_tag {
+	cache_entry ** buckets;
+	size_t n_buckets;		// a power of 2
+	cache_entry * newest;
+	cache_entry * oldest;
+	size_t size;			// bytes taken by the entries
+	size_t max_size;
+} count_cache;
+
+typedef
+struct count_frame_tag {
+	int var;				// decided on in the component being counted
+	int sign;				// of the decision on it, 1 then -1
+	uint64_t hash;			// of the key of the component
+	bignum product;			// of the components of the node counted so far
+	bignum sum;				// of the children of the component counted so far
+} count_frame;
+
+typedef
+struct counter_tag {
+	solver * s;
+	count_cache cache;
+	int * key;				// of the component being looked up
+	size_t key_cap;
+
+	bitstore * levels;		// of each level, its configuration, the clauses left,
+							// then the clauses and variables of its component
+	count_frame * frames;
+	size_t capacity;		// levels allocated
+	bitstore * used;		// scratch of the variables in clauses left
+	int * occ;				// scratch of occurrences, all 0 in between uses
+} counter;
+
+size_t cache_entry_size(const cache_entry * e)
+{
+	return sizeof * e + e->key_len * sizeof * e->key + e->count.cap * sizeof * e->count.limbs;
+}
+
+void cache_init(count_cache * cache, size_t max_size)
+{
+	cache->max_size = max_size ? max_size : COUNT_CACHE_SIZE;
+	cache->n_buckets = 1024;
+	while (cache->n_buckets * 1024 < cache->max_size) cache->n_buckets *= 2;
+	cache->buckets = calloc(cache->n_buckets, sizeof * cache->buckets);
+	cache->newest = cache->oldest = NULL;
+	cache->size = 0;
+}
+
+void cache_unlink(count_cache * cache, cache_entry * e)
+{
+	if (e->newer) e->newer->older = e->older;
+	else          cache->newest = e->older;
+	if (e->older) e->older->newer = e->newer;
+	else          cache->oldest = e->newer;
+}
+
+void cache_push(count_cache * cache, cache_entry * e)
+{
+	e->newer = NULL;
+	e->older = cache->newest;
+	if (cache->newest) cache->newest->newer = e;
+	else               cache->oldest = e;
+	cache->newest = e;
+}
+
+void cache_evict(count_cache * cache)
+{
+	cache_entry * e = cache->oldest;
+	cache_entry ** p = &cache->buckets[e->hash & (cache->n_buckets - 1)];
+
+	while (*p != e) p = &(*p)->next;
+	*p = e->next;
+	cache_unlink(cache, e);
+
+	cache->size -= cache_entry_size(e);
+	free(e->key);
+	bignum_free(&e->count);
+	free(e);
+}
+
+void cache_clean(count_cache * cache)
+{
+	while (cache->oldest) cache_evict(cache);
+	free(cache->buckets);
+}
+
+uint64_t key_hash(const int * key, size_t len)
+{
+	uint64_t h = 14695981039346656037ULL;
+	for (size_t i = 0; i < len; i++) {
+		h ^= (uint32_t) key[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+cache_entry * cache_find(count_cache * cache, uint64_t hash, const int * key, size_t len)
+{
+	cache_entry * e = cache->buckets[hash & (cache->n_buckets - 1)];
+	for (; e != NULL; e = e->next)
+		if (e->hash == hash && e->key_len == len && !memcmp(e->key, key, len * sizeof * key)) {
+			cache_unlink(cache, e);
+			cache_push(cache, e);
+			return e;
+		}
+	return NULL;
+}
+
+void cache_store(count_cache * cache, uint64_t hash, const int * key, size_t len, const bignum * count)
+{
+	cache_entry * e = malloc(sizeof * e);
+	e->hash = hash;
+	e->key_len = len;
+	e->key = malloc(len * sizeof * e->key);
+	memcpy(e->key, key, len * sizeof * e->key);
+	bignum_init(&e->count);
+	bignum_copy(&e->count, count);
+
+	size_t size = cache_entry_size(e);
+	if (size > cache->max_size) {
+		free(e->key);
+		bignum_free(&e->count);
+		free(e);
+		return;
+	}
+	while (cache->size + size > cache->max_size)
+		cache_evict(cache);
+
+	cache_entry ** bucket = &cache->buckets[hash & (cache->n_buckets - 1)];
+	e->next = *bucket;
+	*bucket = e;
+	cache_push(cache, e);
+	cache->size += size;
+}
+
+// Key of a component, its clauses then its variables, in order
+size_t count_key(counter * ct, const bitstore * clauses, const bitstore * vars)
+{
+	const formula * f = ct->s->f;
+	size_t len = 0;
+
+	if (ct->key_cap < f->n_clauses + f->n_vars + 1) {
+		ct->key_cap = f->n_clauses + f->n_vars + 1;
+		ct->key = realloc(ct->key, ct->key_cap * sizeof * ct->key);
+	}
+
+	for (int i = 0; i < f->cconf_len; i++)
+		for (bitstore w = clauses[i]; w; w &= w - 1)
+			ct->key[len++] = i * sbitstore + least_bit_pos(w);
+	ct->key[len++] = 0;
+	for (int i = 0; i < f->olconf_len; i++)
+		for (bitstore w = vars[i]; w; w &= w - 1)
+			ct->key[len++] = i * sbitstore + least_bit_pos(w);
+
+	return len;
+}
+
+// Unit propagation over the given clauses, 0 on a conflict
+int count_propagate(solver * s, bitstore * config, const bitstore * clauses)
+{
+	const formula * f = s->f;
+	int changed = 1;
+
+	while (changed) {
+		changed = 0;
+		for (int i = 0; i < f->cconf_len; i++)
+			for (bitstore w = clauses[i] & ~config[i]; w; w &= w - 1) {
+				int c = i * sbitstore + least_bit_pos(w);
+				if (is_s_set(config, c)) continue; // satisfied by a unit just now
+
+				switch (clause_length(f, config, c)) {
+					case 0: return 0;
+					case 1:
+						lit_assign(s, config, get_unit(f, config, c));
+						changed = 1;
+				}
+			}
+	}
+
+	return 1;
+}
+
+// Unassigned variable of the component in the most of its clauses
+int count_choose(counter * ct, const bitstore * clauses, const bitstore * vars)
+{
+	const formula * f = ct->s->f;
+	int best = 0, best_occ = -1;
+
+	for (int i = 0; i < f->cconf_len; i++)
+		for (bitstore w = clauses[i]; w; w &= w - 1) {
+			int c = i * sbitstore + least_bit_pos(w);
+			for (const int * lit = f->lits + f->clause_offs[c]; *lit; lit++)
+				if (is_s_set(vars, abs(*lit)))
+					ct->occ[abs(*lit)]++;
+		}
+
+	for (int j = 0; j < f->olconf_len; j++)
+		for (bitstore w = vars[j]; w; w &= w - 1) {
+			int var = j * sbitstore + least_bit_pos(w);
+			if (ct->occ[var] > best_occ) best = var, best_occ = ct->occ[var];
+			ct->occ[var] = 0;
+		}
+
+	return best;
+}
+
+// Makes room for one more level, doubling the capacity when needed
+int count_reserve(counter * ct, size_t level)
+{
+	const formula * f = ct->s->f;
+	size_t words = f->cfg_len + 2 * f->cconf_len + f->olconf_len;
+
+	if (level < ct->capacity) return 1;
+
+	size_t capacity = ct->capacity ? 2 * ct->capacity : (1ULL << 18) / (words * sizeof (bitstore)) + 1;
+	if (capacity > f->n_vars + 1) capacity = f->n_vars + 1;
+	if (capacity <= level) capacity = level + 1;
+	if (!within_memory(ct->s, capacity * (words * sizeof (bitstore) + sizeof (count_frame))))
+		return 0;
+
+	bitstore * levels = realloc(ct->levels, capacity * words * sizeof * levels);
+	if (levels == NULL) return 0;
+	ct->levels = levels;
+
+	count_frame * frames = realloc(ct->frames, capacity * sizeof * frames);
+	if (frames == NULL) return 0;
+	ct->frames = frames;
+
+	for (size_t k = ct->capacity; k < capacity; k++) {
+		bignum_init(&frames[k].product);
+		bignum_init(&frames[k].sum);
+	}
+	ct->capacity = capacity;
+	return 1;
+}
+
+// Configuration, clauses left, and clauses then variables of the component, of a level
+bitstore * count_config(counter * ct, size_t level)
+{
+	const formula * f = ct->s->f;
+	return ct->levels + level * (f->cfg_len + 2 * f->cconf_len + f->olconf_len);
+}
+
+bitstore * count_rest(counter * ct, size_t level)
+{
+	return count_config(ct, level) + ct->s->f->cfg_len;
+}
+
+bitstore * count_comp(counter * ct, size_t level)
+{
+	return count_rest(ct, level) + ct->s->f->cconf_len;
+}
+
+/* Sets the child of the level to its configuration with the
+ * decision of the frame applied, for counting it.
+ */
+int count_decide(counter * ct, size_t level)
+{
+	solver * s = ct->s;
+
+	if (!count_reserve(ct, level + 1)) {
+		if (s->stop_reason == NULL) s->stop_reason = "out of memory";
+		return 0;
+	}
+
+	// after reserving, which may move the levels
+	const count_frame * fr = &ct->frames[level];
+
+	bitstore * child = copy_config_to(s->f, count_config(ct, level + 1), count_config(ct, level));
+	s->n_decisions++;
+	lit_assign(s, child, fr->sign * fr->var);
+	return 1;
+}
+
+/* Models of the variables given, over the clauses given, from the
+ * configuration at level 0. Each level is a node, its variables and
+ * clauses the component of the level above being counted: first the
+ * unsatisfied clauses left are split into components, which are
+ * then counted one by one, from the cache or by a decision on one of
+ * their variables, each child a level further down. Returns 0 if
+ * stopped before finding out.
+ */
+int count_tree(counter * ct, const bitstore * vars, const bitstore * clauses, bignum * result)
+{
+	solver * s = ct->s;
+	const formula * f = s->f;
+	size_t level = 0;
+	enum { ENTER, NEXT, LEAVE } step = ENTER;
+
+	for (;;) {
+		count_frame * fr = &ct->frames[level];
+		bitstore * config = count_config(ct, level);
+		bitstore * rest = count_rest(ct, level);
+		bitstore * comp_clauses = count_comp(ct, level);
+		bitstore * comp_vars = comp_clauses + f->cconf_len;
+		const bitstore * node_clauses = level ? count_comp(ct, level - 1) : clauses;
+		const bitstore * node_vars = level ? node_clauses + f->cconf_len : vars;
+
+		if (step == ENTER) {
+			if (should_stop(s)) return 0;
+			stats_progress(s);
+			stat_set(s, frontier, level);
+
+			if (!count_propagate(s, config, node_clauses)) {
+				s->n_conflicts++;
+				fr->product.len = 0;
+				step = LEAVE;
+				continue;
+			}
+
+			bitstore * nconf = config + f->cconf_len;
+			bitstore * pconf = nconf + f->olconf_len;
+			size_t n_free = 0;
+
+			for (int i = 0; i < f->cconf_len; i++)
+				rest[i] = node_clauses[i] & ~config[i];
+			clause_vars(f, config, rest, ct->used);
+			for (int j = 0; j < f->olconf_len; j++)
+				n_free += count_bits(node_vars[j] & ~(nconf[j] | pconf[j]) & ~ct->used[j]);
+
+			bignum_set_pow2(&fr->product, n_free);
+			step = NEXT;
+		}
+
+		if (step == NEXT) {
+			// no models of one component, no models of them all
+			int i = 0;
+			while (i < f->cconf_len && rest[i] == 0) i++;
+			if (fr->product.len == 0 || i == f->cconf_len) {
+				step = LEAVE;
+				continue;
+			}
+
+			int c = i * sbitstore + least_bit_pos(rest[i]);
+			component_grow(f, config, rest, c, comp_clauses, comp_vars);
+			for (int k = 0; k < f->cconf_len; k++)
+				rest[k] &= ~comp_clauses[k];
+			stat_inc(s, components);
+
+			size_t len = count_key(ct, comp_clauses, comp_vars);
+			fr->hash = key_hash(ct->key, len);
+			cache_entry * e = cache_find(&ct->cache, fr->hash, ct->key, len);
+			if (e != NULL) {
+				stat_inc(s, cache_hits);
+				bignum_mul(&fr->product, &e->count);
+				continue;
+			}
+
+			fr->var = count_choose(ct, comp_clauses, comp_vars);
+			fr->sign = 1;
+			fr->sum.len = 0;
+			if (!count_decide(ct, level)) return 0;
+			level++;
+			step = ENTER;
+			continue;
+		}
+
+		// LEAVE, with the models of the node in its product
+		if (level == 0) {
+			bignum_copy(result, &fr->product);
+			return 1;
+		}
+
+		count_frame * parent = &ct->frames[--level];
+		bignum_add(&parent->sum, &fr->product);
+		if (parent->sign == 1) {
+			parent->sign = -1;
+			if (!count_decide(ct, level)) return 0;
+			level++;
+			step = ENTER;
+			continue;
+		}
+
+		// the key was overwritten by the children
+		bitstore * parent_comp = count_comp(ct, level);
+		size_t len = count_key(ct, parent_comp, parent_comp + f->cconf_len);
+		cache_store(&ct->cache, parent->hash, ct->key, len, &parent->sum);
+		bignum_mul(&parent->product, &parent->sum);
+		step = NEXT;
+	}
+}
+
+/* Counts the models in which the assumptions hold, into count.
+ * Results in SUCCESS if there are some, FAIL if none, or TBD if
+ * stopped before finding out. Assumptions on variables beyond the
+ * formula are ignored, and counted as free variables are not.
+ */
+dpll_result solver_count(solver * s, const int * assumptions, size_t n, bignum * count)
+{
+	const formula * f = s->f;
+	stats_t kept = s->stats;
+
+	s->stop_reason = NULL;
+	s->n_decisions = s->n_conflicts = s->n_flips = 0;
+	memset(&s->stats, 0, sizeof s->stats);
+	s->stats.progress_interval = kept.progress_interval;
+	s->stats.phase_time[PHASE_PARSE] = kept.phase_time[PHASE_PARSE];
+
+	if (f->n_cards > 0) {
+		s->stop_reason = "model counting takes no cardinality constraints";
+		return TBD;
+	}
+
+	bitstore * vars = calloc(f->olconf_len, sizeof * vars);
+	bitstore * clauses = calloc(f->cconf_len, sizeof * clauses);
+
+	for (int var = 1; var <= f->n_vars; var++)
+		s_set(vars, var);
+	for (int c = 1; c <= f->n_clauses; c++)
+		s_set(clauses, c);
+
+	counter ct = { s };
+	cache_init(&ct.cache, s->cache_size);
+	ct.used = malloc(f->olconf_len * sizeof * ct.used);
+	ct.occ = calloc(f->n_vars + 1, sizeof * ct.occ);
+	s->search_start = monotonic_sec();
+	s->stats.progress_last = s->search_start;
+
+	dpll_result result = TBD;
+	phase_begin(PHASE_SEARCH);
+
+	count->len = 0;
+	if (!count_reserve(&ct, 0)) {
+		s->stop_reason = "out of memory";
+		n = 0;
+	}
+	bitstore * config = (ct.capacity > 0) ? memset(count_config(&ct, 0), 0, f->cfg_size) : NULL;
+
+	for (size_t i = 0; i < n; i++) {
+		const bitstore * nconf = config + f->cconf_len;
+		const bitstore * pconf = nconf + f->olconf_len;
+		int var = abs(assumptions[i]);
+		if (var == 0 || var > f->n_vars) continue;
+		if (is_s_set(assumptions[i] > 0 ? nconf : pconf, var)) {
+			result = FAIL; // assumed both ways
+			break;
+		}
+		lit_assign(s, config, assumptions[i]);
+	}
+
+	if (result == TBD && config != NULL && count_tree(&ct, vars, clauses, count))
+		result = (count->len > 0) ? SUCCESS : FAIL;
+
+	phase_end(s, PHASE_SEARCH);
+
+	cache_clean(&ct.cache);
+	free(ct.key);
+	for (size_t k = 0; k < ct.capacity; k++) {
+		bignum_free(&ct.frames[k].product);
+		bignum_free(&ct.frames[k].sum);
+	}
+	free(ct.levels);
+	free(ct.frames);
+	free(ct.used);
+	free(ct.occ);
+	free(vars);
+	free(clauses);
+	return result;
+}
+
+/* ==== Symmetry Functions ==== */
+/* Symmetries of a formula are permutations of its literals that
+ * commute with negation and map the clauses onto the clauses. They
+ * are the automorphisms of its graph: a vertex per literal, linked
+ * to its negation, and a vertex per clause, linked to its literals,
+ * the two kinds colored apart. Generators of the group are found by
+ * individualization and refinement, the way saucy and bliss do:
+ *   - colors are refined until equitable, each vertex recolored by
+ *     its color and the multiset of the colors of its neighbors
+ *   - the first path individualizes the first vertex of the first
+ *     cell with more than one, refining after each, down to a leaf
+ *   - from the deepest level of it up, each other vertex of the cell
+ *     not in the orbit of the one on the path yet is individualized
+ *     instead, and a leaf searched below it pairing the vertices of
+ *     the same colors into an automorphism
+ * Refinements are bounded, the generators found until the bound
+ * are symmetries all the same. Each one is broken by a lex-leader
+ * constraint over the variables it moves, in the order of them, up
+ * to a bounded number of them, chained through auxiliary variables:
+ * an assignment is ruled out if the one it is mapped to is less,
+ * and the least in each orbit is always left.
+ */
+#define SYM_REFINEMENTS 20000	// of the whole search, at most
+#define SYM_CHAIN 64			// variables of a lex-leader constraint, at most
+
+typedef
+struct sym_key_tag {
+	int color;
+	int vertex;
+	uint64_t hash;			// of the colors of the neighbors
+} sym_key;
+
+typedef
+struct sym_graph_tag {
+	int n;					// vertices, the literals 2 per variable, then the clauses
+	int * offs;				// where the neighbors of each vertex start in adj
+	int * adj;				// sorted for each vertex, for finding edges
+	unsigned int budget;	// refinements left
+
+	int depth;				// of the first path
+	int * path;				// vertex individualized at each level
+	int * cells;			// color of the cell it was in
+	int * n_colors;			// after refining at each level
+	uint64_t * shapes;		// hashes of the sizes of the cells at each level
+	int * leaf;				// vertex of each color at the end of the first path
+
+	int * orbits;			// union-find over the generators found so far
+	int * perm;				// image of each vertex, of the automorphism checked
+	sym_key * keys;			// scratch of refinement
+	int * sizes;
+} sym_graph;
+
+int lit_vertex(int lit)
+{
+	return 2 * (abs(lit) - 1) + (lit < 0);
+}
+
+int vertex_lit(int vertex)
+{
+	return (vertex & 1) ? -(vertex / 2 + 1) : vertex / 2 + 1;
+}
+
+int sym_key_cmp(const void * a, const void * b)
+{
+	const sym_key * x = a;
+	const sym_key * y = b;
+
+	if (x->color != y->color) return (x->color > y->color) - (x->color < y->color);
+	return (x->hash > y->hash) - (x->hash < y->hash);
+}
+
+void sym_build(sym_graph * g, const formula * f)
+{
+	int n_lit_vertices = 2 * f->n_vars;
+	g->n = n_lit_vertices + f->n_clauses;
+	g->offs = calloc(g->n + 1, sizeof * g->offs);
+	g->adj = malloc((2 * (size_t) f->n_lits + n_lit_vertices) * sizeof * g->adj);
+
+	// degrees first, then the neighbors into their places
+	for (int v = 0; v < n_lit_vertices; v++)
+		g->offs[v + 1] = 1;
+	for (int c = 1; c <= f->n_clauses; c++)
+		for (const int * lit = f->lits + f->clause_offs[c]; *lit; lit++) {
+			g->offs[lit_vertex(*lit) + 1]++;
+			g->offs[n_lit_vertices + c]++;
+		}
+	for (int v = 0; v < g->n; v++)
+		g->offs[v + 1] += g->offs[v];
+
+	int * fill = malloc(g->n * sizeof * fill);
+	memcpy(fill, g->offs, g->n * sizeof * fill);
+	for (int v = 0; v < n_lit_vertices; v++)
+		g->adj[fill[v]++] = v ^ 1;
+	for (int c = 1; c <= f->n_clauses; c++)
+		for (const int * lit = f->lits + f->clause_offs[c]; *lit; lit++) {
+			int v = lit_vertex(*lit);
+			int u = n_lit_vertices + c - 1;
+			g->adj[fill[v]++] = u;
+			g->adj[fill[u]++] = v;
+		}
+	free(fill);
+
+	for (int v = 0; v < g->n; v++)
+		qsort(g->adj + g->offs[v], g->offs[v + 1] - g->offs[v], sizeof * g->adj, int_cmp);
+
+	g->budget = SYM_REFINEMENTS;
+	g->path = malloc((g->n + 1) * sizeof * g->path);
+	g->cells = malloc((g->n + 1) * sizeof * g->cells);
+	g->n_colors = malloc((g->n + 1) * sizeof * g->n_colors);
+	g->shapes = malloc((g->n + 1) * sizeof * g->shapes);
+	g->leaf = malloc(g->n * sizeof * g->leaf);
+	g->orbits = malloc(g->n * sizeof * g->orbits);
+	g->perm = malloc(g->n * sizeof * g->perm);
+	g->keys = malloc(g->n * sizeof * g->keys);
+	g->sizes = malloc(g->n * sizeof * g->sizes);
+
+	for (int v = 0; v < g->n; v++)
+		g->orbits[v] = v;
+}
+
+void sym_free(sym_graph * g)
+{
+	free(g->offs);
+	free(g->adj);
+	free(g->path);
+	free(g->cells);
+	free(g->n_colors);
+	free(g->shapes);
+	free(g->leaf);
+	free(g->orbits);
+	free(g->perm);
+	free(g->keys);
+	free(g->sizes);
+}
+
+/* Refines the colors until equitable, numbering the new colors in
+ * the order of the old ones, and of the hashes of the neighbors'
+ * colors among the same. Returns the number of colors.
+ */
+int sym_refine(sym_graph * g, int * color, int k)
+{
+	if (g->budget > 0) g->budget--;
+
+	for (;;) {
+		for (int v = 0; v < g->n; v++) {
+			uint64_t hash = 0;
+			for (int i = g->offs[v]; i < g->offs[v + 1]; i++)
+				hash += mix64(color[g->adj[i]]);
+			g->keys[v] = (sym_key) { color[v], v, hash };
+		}
+		qsort(g->keys, g->n, sizeof * g->keys, sym_key_cmp);
+
+		int n_colors = 0;
+		for (int i = 0; i < g->n; i++) {
+			if (i == 0 || sym_key_cmp(&g->keys[i - 1], &g->keys[i]) != 0)
+				n_colors++;
+			color[g->keys[i].vertex] = n_colors - 1;
+		}
+
+		if (n_colors == k) return k;
+		k = n_colors;
+	}
+}
+
+// Hash of the sizes of the cells, and the first one with more than a vertex, or -1
+uint64_t sym_shape(sym_graph * g, const int * color, int k, int * cell)
+{
+	uint64_t hash = k;
+
+	memset(g->sizes, 0, k * sizeof * g->sizes);
+	for (int v = 0; v < g->n; v++)
+		g->sizes[color[v]]++;
+
+	*cell = -1;
+	for (int c = 0; c < k; c++) {
+		hash = mix64(hash ^ g->sizes[c]);
+		if (*cell < 0 && g->sizes[c] > 1) *cell = c;
+	}
+	return hash;
+}
+
+// Gives the vertex a color of its own, right before the rest of its cell
+void sym_individualize(const sym_graph * g, int * color, int vertex)
+{
+	int c = color[vertex];
+	for (int v = 0; v < g->n; v++)
+		if (color[v] > c || (color[v] == c && v != vertex))
+			color[v]++;
+}
+
+int sym_edge(const sym_graph * g, int u, int v)
+{
+	return bsearch(&v, g->adj + g->offs[u], g->offs[u + 1] - g->offs[u], sizeof v, int_cmp) != NULL;
+}
+
+int sym_is_automorphism(const sym_graph * g)
+{
+	for (int u = 0; u < g->n; u++)
+		for (int i = g->offs[u]; i < g->offs[u + 1]; i++)
+			if (!sym_edge(g, g->perm[u], g->perm[g->adj[i]]))
+				return 0;
+	return 1;
+}
+
+int orbit_find(int * orbits, int v)
+{
+	while (orbits[v] != v)
+		v = orbits[v] = orbits[orbits[v]];
+	return v;
+}
+
+/* Searches below the colors, at the level d of the first path, for
+ * a leaf making an automorphism, left in perm. Returns 1 if found,
+ * 0 if there is none, and -1 when out of refinements.
+ */
+int sym_search(sym_graph * g, int * color, int k, int d)
+{
+	int cell;
+
+	if (g->budget == 0) return -1;
+	k = sym_refine(g, color, k);
+	if (k != g->n_colors[d] || sym_shape(g, color, k, &cell) != g->shapes[d])
+		return 0;
+
+	if (cell < 0) {
+		for (int v = 0; v < g->n; v++)
+			g->perm[g->leaf[color[v]]] = v;
+		return sym_is_automorphism(g);
+	}
+
+	int * child = malloc(g->n * sizeof * child);
+	int found = 0;
+	for (int v = 0; found == 0 && v < g->n; v++) if (color[v] == cell) {
+		memcpy(child, color, g->n * sizeof * child);
+		sym_individualize(g, child, v);
+		found = sym_search(g, child, k + 1, d + 1);
+	}
+	free(child);
+	return found;
+}
+
+// Colors of the first path at the level d, before its individualization there
+int sym_replay(sym_graph * g, const int * initial, int k, int d, int * color)
+{
+	memcpy(color, initial, g->n * sizeof * color);
+	k = sym_refine(g, color, k);
+	for (int j = 0; j < d; j++) {
+		sym_individualize(g, color, g->path[j]);
+		k = sym_refine(g, color, k + 1);
+	}
+	return k;
+}
+
+/* Adds the lex-leader constraint of the generator, given as the
+ * variables it moves in order, each followed by its image literal,
+ * ending with a 0.
+ */
+void sym_break(formula * f, const int * moved)
+{
+	int prev = 0; // the variables so far are equal to their images, if true
+
+	for (int i = 0; moved[i]; i += 2) {
+		int x = moved[i], image = moved[i + 1];
+		int clause[4], n = 0;
+
+		if (prev) clause[n++] = -prev;
+		clause[n++] = -x;
+		if (image == -x) { // x cannot be true, nor equal to its image
+			formula_add_clause(f, clause, n);
+			return;
+		}
+		clause[n++] = image;
+		formula_add_clause(f, clause, n);
+		if (!moved[i + 2]) return;
+
+		int y = f->n_vars + 1;
+		formula_add_vars(f, y);
+		f->n_aux_vars++;
+
+		clause[n - 1] = y;
+		formula_add_clause(f, clause, n);
+		clause[n - 2] = image;
+		formula_add_clause(f, clause, n);
+		prev = y;
+	}
+}
+
+/* Finds generators of the symmetries of the formula, and appends
+ * their lex-leader constraints. Returns the number of generators.
+ */
+unsigned int formula_break_symmetry(formula * f)
+{
+	// the graph is of the clauses, blind to the constraints
+	if (f->n_vars == 0 || f->n_cards > 0) return 0;
+
+	sym_graph g;
+	sym_build(&g, f);
+
+	int * initial = malloc(g.n * sizeof * initial);
+	int * color = malloc(g.n * sizeof * color);
+	int * child = malloc(g.n * sizeof * child);
+	int k0 = (g.n > 2 * f->n_vars) ? 2 : 1;
+	for (int v = 0; v < g.n; v++)
+		initial[v] = v >= 2 * f->n_vars;
+
+	// the first path
+	int cell;
+	int k = sym_refine(&g, memcpy(color, initial, g.n * sizeof * color), k0);
+	g.depth = 0;
+	for (;;) {
+		g.n_colors[g.depth] = k;
+		g.shapes[g.depth] = sym_shape(&g, color, k, &cell);
+		if (cell < 0) break;
+
+		int v = 0;
+		while (color[v] != cell) v++;
+		g.path[g.depth] = v;
+		g.cells[g.depth++] = cell;
+		sym_individualize(&g, color, v);
+		k = sym_refine(&g, color, k + 1);
+	}
+	for (int v = 0; v < g.n; v++)
+		g.leaf[color[v]] = v;
+
+	// the generators, from the deepest level up, as the variables they move
+	int * gens = NULL;
+	size_t gens_len = 0;
+	unsigned int n_gens = 0;
+	int found = 0;
+
+	for (int d = g.depth - 1; d >= 0 && found >= 0; d--) {
+		k = sym_replay(&g, initial, k0, d, color);
+		int v = g.path[d];
+
+		for (int w = 0; found >= 0 && w < g.n; w++) {
+			if (w == v || color[w] != g.cells[d] || orbit_find(g.orbits, w) == orbit_find(g.orbits, v))
+				continue;
+
+			memcpy(child, color, g.n * sizeof * child);
+			sym_individualize(&g, child, w);
+			if ((found = sym_search(&g, child, k + 1, d + 1)) <= 0)
+				continue;
+
+			for (int u = 0; u < g.n; u++)
+				g.orbits[orbit_find(g.orbits, u)] = orbit_find(g.orbits, g.perm[u]);
+
+			gens = realloc(gens, (gens_len + 2 * SYM_CHAIN + 1) * sizeof * gens);
+			int n_moved = 0;
+			for (int x = 1; x <= f->n_vars && n_moved < SYM_CHAIN; x++) {
+				int image = vertex_lit(g.perm[lit_vertex(x)]);
+				if (image == x) continue;
+				gens[gens_len++] = x;
+				gens[gens_len++] = image;
+				n_moved++;
+			}
+			// ones swapping duplicate clauses alone have nothing to break
+			if (n_moved > 0) {
+				gens[gens_len++] = 0;
+				n_gens++;
+			}
+		}
+	}
+
+	sym_free(&g);
+	free(initial);
+	free(color);
+	free(child);
+
+	for (size_t i = 0; i < gens_len; i++) {
+		sym_break(f, gens + i);
+		while (gens[i]) i += 2;
+	}
+	free(gens);
+	return n_gens;
+}
+
+/* ==== Cardinality Functions ==== */
+/* At-most-one constraints encoded pairwise, a binary clause for
+ * every two of their literals, take a number of clauses quadratic
+ * in theirs, each of them checked by every reduction step. A binary
+ * clause (a b) is an at-most-one of -a and -b, so such constraints
+ * are cliques of the graph of binary clauses, found greedily from
+ * the literals in the most of them. Ones of CARD_MIN_LEN literals or
+ * more replace their clauses, the smaller ones pay off no better than
+ * the clauses, which are left. A literal is in one constraint at most,
+ * and its negation in none, for purity to tell which way is safe.
+ *
+ * The sequential counter of Sinz encodes one of x1 ... xn in 3n - 4
+ * binary clauses over n - 1 auxiliary variables s1 ... sn-1:
+ *   (-xi si), (-si si+1) and (-xi+1 -si)
+ * each si true once one of x1 ... xi is. Its auxiliary variables are
+ * in no other clause, so the chains are followed from the literals
+ * in a single clause each, and replaced before the cliques are looked
+ * for. The auxiliary variables are then in no clause at all, and set
+ * in the models from the constraint. Counters of at most k > 1, of
+ * k auxiliary variables at each literal, are left as clauses.
+ *
+ * The constraints are propagated by the count of their true literals:
+ * two are a conflict, and one assigns the rest of them false. The
+ * assignment last found with nothing to propagate is kept, and only
+ * the constraints of the variables assigned otherwise since are
+ * counted again, through their lists of literals. Purity takes each literal
+ * of them as an occurrence of its negation, so that it never sets
+ * one true, as long as the constraint could still be broken: one
+ * with no more than one true or unassigned literal is finished, the
+ * way a satisfied clause is, and its literals stand for nothing.
+ * Local search, probes, counting, decomposition and symmetries see
+ * the clauses alone, and are left out with these constraints.
+ */
+#define CARD_MIN_LEN 4
+
+struct card_system_tag {
+	unsigned int n_cards;
+	int * lits;				// of each constraint, one after another
+	int * offs;				// where each constraint starts in lits, and where the last ends
+	int * var_offs;			// where the constraints of each variable start in of_var
+	int * of_var;
+	size_t words;			// of the assignment kept, olconf_len when built
+	bitstore * checked;		// nconf then pconf of the assignment with nothing to propagate
+	int valid;				// whether checked was ever taken
+	unsigned char * queued;	// of each constraint
+	int * queue;
+	unsigned char * state;	// of each variable, as var_state of the occurrences it stands for
+							// in the constraints not finished
+};
+
+/* Rebuilds the formula without the clauses given, and without the
+ * literals cleared from the bitmaps of the rest, keeping its
+ * variables and everything else that is not of the clauses.
+ */
+void formula_remove_clauses(formula * f, const bitstore * removed)
+{
+	formula * g = formula_new();
+	formula_add_vars(g, f->n_vars);
+	int * kept = malloc((f->lits_len + 1) * sizeof * kept);
+
+	for (int c = 1; c <= f->n_clauses; c++) if (!is_s_set(removed, c)) {
+		size_t n = 0;
+		for (const int * lit = f->lits + f->clause_offs[c]; *lit; lit++)
+			if (is_s_set(f->clauses[*lit > 0 ? c : -c], abs(*lit)))
+				kept[n++] = *lit;
+		formula_add_clause(g, kept, n);
+	}
+	free(kept);
+
+	g->n_aux_vars = f->n_aux_vars;
+	g->cards = f->cards;
+	g->cards_len = f->cards_len;
+	g->n_cards = f->n_cards;
+	g->counters = f->counters;
+	g->counters_len = f->counters_len;
+	f->cards = NULL;
+	f->counters = NULL;
+
+	formula * old = malloc(sizeof * old);
+	*old = *f;
+	*f = *g;
+	free(g);
+	formula_free(old);
+}
+
+void cards_push(formula * f, int value)
+{
+	f->cards = realloc(f->cards, (f->cards_len + 1) * sizeof * f->cards);
+	f->cards[f->cards_len++] = value;
+}
+
+void counters_push(formula * f, int value)
+{
+	f->counters = realloc(f->counters, (f->counters_len + 1) * sizeof * f->counters);
+	f->counters[f->counters_len++] = value;
+}
+
+int lit_neighbor(const int * offs, const int * adj, int u, int v)
+{
+	return bsearch(&v, adj + offs[u], offs[u + 1] - offs[u], sizeof v, int_cmp) != NULL;
+}
+
+// Binary clauses with the literal, edges of its negation
+int bin_degree(const int * offs, int lit)
+{
+	return offs[lit_vertex(-lit) + 1] - offs[lit_vertex(-lit)];
+}
+
+// Binary clause (a b), 0 if there is none
+int bin_clause(const int * offs, const int * adj, const int * clause_of, int a, int b)
+{
+	for (int e = offs[lit_vertex(-a)]; e < offs[lit_vertex(-a) + 1]; e++)
+		if (adj[e] == lit_vertex(-b)) return clause_of[e];
+	return 0;
+}
+
+/* Follows the sequential counter from the literal of its first
+ * auxiliary variable, true once the first literal of its constraint
+ * is, into its literals, its auxiliaries and its clauses, each with
+ * room for n_vars. Returns the number of literals, 0 if it is none.
+ */
+int counter_follow(const int * offs, const int * adj, const int * clause_of, const int * occ,
+	int n_vars, int a, int * xs, int * aux, int * cls)
+{
+	int n = 0, n_cls = 0;
+	int e = offs[lit_vertex(-a)];
+
+	// (-x1 s1)
+	xs[n] = vertex_lit(adj[e]);
+	cls[n_cls++] = clause_of[e];
+
+	for (;;) {
+		if (n >= n_vars) return 0; // around in a circle
+		aux[n++] = a;
+		int other[2], deg = bin_degree(offs, -a);
+		if (occ[lit_vertex(-a)] != deg || deg < 1 || deg > 2)
+			return 0;
+		for (int i = 0; i < deg; i++)
+			other[i] = -vertex_lit(adj[offs[lit_vertex(a)] + i]);
+
+		// (-xn -sn-1) ends it
+		if (deg == 1) {
+			xs[n] = -other[0];
+			cls[n_cls++] = bin_clause(offs, adj, clause_of, -a, other[0]);
+			return n + 1;
+		}
+
+		// (-si si+1), with si+1 in no other clause than (-xi+1 si+1),
+		// and -si+1 in one or two binary ones, as -xi+1 seldom is
+		int next = 0;
+		for (int i = 0; i < 2 && !next; i++) {
+			int b = other[i], x = other[1 - i], deg_neg = bin_degree(offs, -b);
+			if (occ[lit_vertex(b)] == 2 && bin_degree(offs, b) == 2 && bin_clause(offs, adj, clause_of, b, x) &&
+				occ[lit_vertex(-b)] == deg_neg && deg_neg >= 1 && deg_neg <= 2)
+				next = b, xs[n] = -x;
+		}
+		if (!next) return 0;
+
+		cls[n_cls++] = bin_clause(offs, adj, clause_of, -a, next);
+		cls[n_cls++] = bin_clause(offs, adj, clause_of, -a, -xs[n]);
+		cls[n_cls++] = bin_clause(offs, adj, clause_of, next, -xs[n]);
+		a = next;
+	}
+}
+
+/* Finds the at-most-one constraints in the binary clauses, encoded
+ * as sequential counters or pairwise, replacing them with cardinality
+ * constraints. Returns the number of those.
+ */
+unsigned int formula_find_cardinality(formula * f)
+{
+	int n_lits = 2 * f->n_vars;
+	int * offs = calloc(n_lits + 1, sizeof * offs);
+	int * adj = NULL;
+	int * clause_of = NULL; // binary clause of each edge of adj, for removing them
+
+	// edges between the negations of the literals of each binary clause
+	for (int pass = 0; pass < 2; pass++) {
+		int * fill = pass ? memcpy(malloc(n_lits * sizeof * fill), offs, n_lits * sizeof * fill) : NULL;
+
+		for (int c = 1; c <= f->n_clauses; c++) {
+			const int * lits = f->lits + f->clause_offs[c];
+			if (lits[0] == 0 || lits[1] == 0 || lits[2] != 0 || abs(lits[0]) == abs(lits[1]))
+				continue;
+
+			int u = lit_vertex(-lits[0]), v = lit_vertex(-lits[1]);
+			if (!pass) {
+				offs[u + 1]++;
+				offs[v + 1]++;
+				continue;
+			}
+			adj[fill[u]] = v, clause_of[fill[u]++] = c;
+			adj[fill[v]] = u, clause_of[fill[v]++] = c;
+		}
+
+		if (!pass) {
+			for (int u = 0; u < n_lits; u++)
+				offs[u + 1] += offs[u];
+			adj = malloc(offs[n_lits] * sizeof * adj + 1);
+			clause_of = malloc(offs[n_lits] * sizeof * clause_of + 1);
+		}
+		free(fill);
+	}
+
+	unsigned char * used = calloc(n_lits, 1);
+	bitstore * removed = calloc(f->n_clauses / sbitstore + 1, sizeof * removed);
+	unsigned int n_cards = 0, n_removed = 0;
+
+	// literals of the constraints there already are
+	for (const int * p = f->cards; p < f->cards + f->cards_len; p++)
+		for (; *p; p++) used[lit_vertex(*p)] = 1;
+
+	// sequential counters, from the literals of their first auxiliary variables
+	int * occ = calloc(n_lits, sizeof * occ);
+	for (size_t i = 0; i < f->lits_len; i++)
+		if (f->lits[i]) occ[lit_vertex(f->lits[i])]++;
+
+	int * xs = malloc((f->n_vars + 1) * sizeof * xs);
+	int * aux = malloc((f->n_vars + 1) * sizeof * aux);
+	int * cls = malloc(3 * f->n_vars * sizeof * cls + 1);
+	unsigned char * mark = calloc(f->n_vars + 1, 1);
+
+	for (int u = 0; u < n_lits; u++) {
+		int a = vertex_lit(u);
+		if (occ[u] != 1 || bin_degree(offs, a) != 1 || used[u] || used[u ^ 1])
+			continue;
+
+		int n = counter_follow(offs, adj, clause_of, occ, f->n_vars, a, xs, aux, cls);
+		int ok = n >= CARD_MIN_LEN;
+
+		// every variable once, and none of another constraint
+		for (int i = 0; ok && i < n; i++) {
+			ok = !mark[abs(xs[i])] && !used[lit_vertex(xs[i])] && !used[lit_vertex(-xs[i])];
+			mark[abs(xs[i])] = 1;
+			if (ok && i < n - 1) {
+				ok = !mark[abs(aux[i])];
+				mark[abs(aux[i])] = 1;
+			}
+		}
+		for (int i = 0; i < n; i++) {
+			mark[abs(xs[i])] = 0;
+			if (i < n - 1) mark[abs(aux[i])] = 0;
+		}
+		if (!ok) continue;
+
+		for (int i = 0; i < n; i++) {
+			cards_push(f, xs[i]);
+			counters_push(f, xs[i]);
+			used[lit_vertex(xs[i])] = 1;
+		}
+		cards_push(f, 0);
+		counters_push(f, 0);
+		for (int i = 0; i < n - 1; i++) {
+			counters_push(f, aux[i]);
+			used[lit_vertex(aux[i])] = used[lit_vertex(-aux[i])] = 1;
+		}
+		counters_push(f, 0);
+		for (int i = 0; i < 3 * n - 4; i++)
+			s_set(removed, cls[i]);
+		n_removed += 3 * n - 4;
+		n_cards++;
+	}
+
+	free(occ);
+	free(xs);
+	free(aux);
+	free(cls);
+	free(mark);
+
+	// sorted neighbors, each with its clause, for the search
+	int * sorted = malloc(offs[n_lits] * sizeof * sorted + 1);
+	memcpy(sorted, adj, offs[n_lits] * sizeof * sorted);
+	for (int u = 0; u < n_lits; u++)
+		qsort(sorted + offs[u], offs[u + 1] - offs[u], sizeof * sorted, int_cmp);
+
+	// literals by their degrees, the most first
+	sym_key * order = malloc(n_lits * sizeof * order + 1);
+	for (int u = 0; u < n_lits; u++)
+		order[u] = (sym_key) { 0, u, ~(uint64_t) (offs[u + 1] - offs[u]) };
+	qsort(order, n_lits, sizeof * order, sym_key_cmp);
+
+	unsigned char * in_clique = calloc(n_lits, 1);
+	int * clique = malloc((f->n_vars + 1) * sizeof * clique);
+
+	for (int i = 0; i < n_lits; i++) {
+		int u = order[i].vertex;
+		if (offs[u + 1] - offs[u] < CARD_MIN_LEN - 1) break;
+		if (used[u] || used[u ^ 1]) continue;
+
+		int n = 0;
+		clique[n++] = u;
+		in_clique[u] = 1;
+		for (int e = offs[u]; e < offs[u + 1]; e++) {
+			int v = sorted[e], ok = !used[v] && !used[v ^ 1] && !in_clique[v] && !in_clique[v ^ 1];
+			for (int j = 0; ok && j < n; j++)
+				ok = lit_neighbor(offs, sorted, v, clique[j]);
+			if (ok) clique[n++] = v, in_clique[v] = 1;
+		}
+
+		if (n >= CARD_MIN_LEN) {
+			for (int j = 0; j < n; j++) {
+				int v = clique[j];
+				cards_push(f, vertex_lit(v));
+				used[v] = 1;
+				for (int e = offs[v]; e < offs[v + 1]; e++)
+					if (in_clique[adj[e]] && !is_s_set(removed, clause_of[e])) {
+						s_set(removed, clause_of[e]);
+						n_removed++;
+					}
+			}
+			cards_push(f, 0);
+			n_cards++;
+		}
+		for (int j = 0; j < n; j++)
+			in_clique[clique[j]] = 0;
+	}
+
+	f->n_cards += n_cards;
+	if (n_removed > 0)
+		formula_remove_clauses(f, removed);
+
+	free(offs);
+	free(adj);
+	free(clause_of);
+	free(sorted);
+	free(order);
+	free(used);
+	free(in_clique);
+	free(clique);
+	free(removed);
+	return n_cards;
+}
+
+// Lists of the cardinality constraints of the formula, NULL if there are none
+card_system * card_build(const formula * f)
+{
+	if (f->n_cards == 0) return NULL;
+
+	card_system * cs = calloc(1, sizeof * cs);
+	unsigned int n = cs->n_cards = f->n_cards;
+	cs->lits = malloc(f->cards_len * sizeof * cs->lits);
+	cs->offs = malloc((n + 1) * sizeof * cs->offs);
+	cs->var_offs = calloc(f->n_vars + 2, sizeof * cs->var_offs);
+	cs->state = calloc(f->n_vars + 1, 1);
+
+	const int * p = f->cards;
+	int n_lits = 0;
+	for (unsigned int i = 0; i < n; i++, p++) {
+		cs->offs[i] = n_lits;
+		for (; *p; p++) {
+			cs->lits[n_lits++] = *p;
+			cs->var_offs[abs(*p) + 1]++;
+		}
+	}
+	cs->offs[n] = n_lits;
+
+	for (int var = 1; var <= f->n_vars; var++)
+		cs->var_offs[var + 1] += cs->var_offs[var];
+	int * fill = memcpy(malloc((f->n_vars + 1) * sizeof * fill), cs->var_offs, (f->n_vars + 1) * sizeof * fill);
+	cs->of_var = malloc(n_lits * sizeof * cs->of_var + 1);
+	for (unsigned int i = 0; i < n; i++)
+		for (int j = cs->offs[i]; j < cs->offs[i + 1]; j++)
+			cs->of_var[fill[abs(cs->lits[j])]++] = i;
+	free(fill);
+
+	cs->words = f->olconf_len;
+	cs->checked = malloc(2 * cs->words * sizeof * cs->checked);
+	cs->queued = calloc(n, 1);
+	cs->queue = malloc(n * sizeof * cs->queue);
+	return cs;
+}
+
+void card_free(card_system * cs)
+{
+	if (cs == NULL) return;
+	free(cs->lits);
+	free(cs->offs);
+	free(cs->var_offs);
+	free(cs->of_var);
+	free(cs->checked);
+	free(cs->queued);
+	free(cs->queue);
+	free(cs->state);
+	free(cs);
+}
+
+/* Sets the occurrences the literals of the constraints not
+ * finished in the configuration stand for, for purity.
+ */
+void card_refresh(solver * s, bitstore * config)
+{
+	card_system * cs = s->cards;
+	bitstore * nconf = config + s->f->cconf_len;
+	bitstore * pconf = nconf + s->f->olconf_len;
+
+	memset(cs->state, 0, s->f->n_vars + 1);
+	for (unsigned int i = 0; i < cs->n_cards; i++) {
+		int n_open = 0; // true or unassigned
+
+		for (int j = cs->offs[i]; j < cs->offs[i + 1]; j++) {
+			int lit = cs->lits[j];
+			n_open += !is_s_set(lit > 0 ? nconf : pconf, abs(lit));
+		}
+		if (n_open <= 1) continue;
+
+		for (int j = cs->offs[i]; j < cs->offs[i + 1]; j++) {
+			int lit = cs->lits[j];
+			cs->state[abs(lit)] |= (lit > 0) ? 0b10 : 0b01;
+		}
+	}
+}
+
+// Occurrences the literals of the constraints stand for, as var_state tells
+unsigned int card_state(const solver * s, int var)
+{
+	return (s->cards != NULL) ? s->cards->state[var] : 0;
+}
+
+/* Assigns false the rest of the literals of the constraints with
+ * one true. Returns the number of literals assigned, or -1 on a
+ * constraint with two.
+ */
+int card_propagate(solver * s, bitstore * config)
+{
+	card_system * cs = s->cards;
+	bitstore * nconf = config + s->f->cconf_len;
+	bitstore * pconf = nconf + s->f->olconf_len;
+	size_t words = cs->words;
+	int n = 0, assigned = 0;
+
+	// the constraints of the variables assigned otherwise than when checked, all of them at first
+	if (!cs->valid)
+		for (unsigned int i = 0; i < cs->n_cards; i++)
+			cs->queue[n++] = i, cs->queued[i] = 1;
+	else
+		for (size_t j = 0; j < words; j++)
+			for (bitstore w = (nconf[j] ^ cs->checked[j]) | (pconf[j] ^ cs->checked[words + j]); w; w &= w - 1) {
+				int var = j * sbitstore + least_bit_pos(w);
+				for (int e = cs->var_offs[var]; e < cs->var_offs[var + 1]; e++)
+					if (!cs->queued[cs->of_var[e]])
+						cs->queue[n++] = cs->of_var[e], cs->queued[cs->of_var[e]] = 1;
+			}
+
+	for (int q = 0; q < n; q++) {
+		int i = cs->queue[q], n_true = 0, n_free = 0;
+		cs->queued[i] = 0;
+		if (assigned < 0) continue;
+
+		for (int j = cs->offs[i]; j < cs->offs[i + 1]; j++) {
+			int lit = cs->lits[j];
+			if (is_s_set(lit > 0 ? pconf : nconf, abs(lit))) n_true++;
+			else if (!is_s_set(lit > 0 ? nconf : pconf, abs(lit))) n_free++;
+		}
+		if (n_true > 1) {
+			assigned = -1;
+			continue;
+		}
+		if (n_true == 0 || n_free == 0) continue;
+
+		for (int j = cs->offs[i]; j < cs->offs[i + 1]; j++) {
+			int lit = cs->lits[j];
+			if (is_s_set(nconf, abs(lit)) || is_s_set(pconf, abs(lit))) continue;
+			stat_inc(s, card_units);
+			lit_assign(s, config, -lit);
+		}
+		assigned += n_free;
+	}
+
+	// every constraint is as it was checked, or counted again, and none has anything to propagate
+	if (assigned == 0) {
+		memcpy(cs->checked, nconf, words * sizeof * nconf);
+		memcpy(cs->checked + words, pconf, words * sizeof * pconf);
+		cs->valid = 1;
+	}
+
+	return assigned;
+}
+
+/* Sets the auxiliary variables of the sequential counters replaced
+ * the way their clauses ask: each true once a literal of the
+ * constraint up to its own is.
+ */
+void counters_extend_model(const formula * f, bitstore * config)
+{
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+
+	for (const int * p = f->counters; p < f->counters + f->counters_len; p++) {
+		const int * aux = p;
+		while (*aux) aux++;
+		int any = 0;
+
+		for (aux++; *aux; p++, aux++) {
+			any |= var_value(f, config, abs(*p)) == (*p > 0);
+			int var = abs(*aux);
+			s_clear(nconf, var);
+			s_clear(pconf, var);
+			s_set((any == (*aux > 0)) ? pconf : nconf, var);
+		}
+		p = aux;
+	}
+}
+
+/* ==== Vivification Functions ==== */
+/* A clause (l1 ... lk) is vivified by assigning -l1, -l2, ... in
+ * turn, propagating the units of the rest of the formula after each:
+ *   - a conflict after -li leaves (l1 ... li) implied by the rest
+ *   - a literal li found true leaves (l1 ... li) implied as well
+ *   - a literal found false is left out, the clause resolving with
+ *     its reason into one without it
+ * A clause implied by the rest, with no literal found false, is
+ * deleted, and a shorter one replaces it otherwise, a lemma of the
+ * proof RUP by the same propagation. The longest clauses go first,
+ * in a budget of clauses checked by propagation, a pass over all of
+ * them per literal. It is a single pass before the search, which
+ * keeps the clauses by their indices in every configuration, and
+ * the rebuilt formula would number them anew.
+ */
+int lit_kept(const int * kept, size_t n, int lit)
+{
+	for (size_t i = 0; i < n; i++)
+		if (kept[i] == lit) return 1;
+	return 0;
+}
+
+unsigned int formula_vivify(formula * f, unsigned long long budget, drat_proof * proof, unsigned int * deleted)
+{
+	solver s;
+	solver_init(&s, f);
+	s.cards = card_build(f);
+
+	bitstore * base = calloc(f->cfg_len, sizeof * base); // the deleted clauses, as satisfied
+	bitstore * config = malloc(f->cfg_size);
+	bitstore * nconf = config + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+	int * kept = malloc((f->lits_len + 1) * sizeof * kept);
+	sym_key * order = malloc((f->n_clauses + 1) * sizeof * order);
+	unsigned int n_order = 0, strengthened = 0;
+	unsigned long long effort = 0;
+
+	// clauses by their lengths, the longest first
+	for (int c = 1; c <= f->n_clauses; c++) {
+		int n = 0;
+		for (int i = 0; i < f->olconf_len; i++)
+			n += count_bits(f->clauses[c][i]) + count_bits(f->clauses[-c][i]);
+		if (n >= 2 && !is_tautology(f, c))
+			order[n_order++] = (sym_key) { 0, c, ~(uint64_t) n };
+	}
+	qsort(order, n_order, sizeof * order, sym_key_cmp);
+	*deleted = 0;
+
+	for (unsigned int i = 0; i < n_order && effort < budget; i++) {
+		int c = order[i].vertex;
+		const int * lits = f->lits + f->clause_offs[c];
+		size_t n_lits = ~order[i].hash, n_kept = 0, len = 0;
+		int implied = 0, dropped = 0;
+		while (lits[len]) len++;
+
+		memcpy(config, base, f->cfg_size);
+		s_set(config, c);
+		effort += f->n_clauses;
+		if (!unit_reductions(&s, config))
+			break; // the rest is unsatisfiable on its own, left to the search
+
+		for (const int * lit = lits; *lit && !implied; lit++) {
+			int var = abs(*lit);
+			if (is_s_set(*lit > 0 ? pconf : nconf, var)) {
+				kept[n_kept++] = *lit;
+				implied = 1;
+			}
+			else if (!is_s_set(*lit > 0 ? nconf : pconf, var)) {
+				kept[n_kept++] = *lit;
+				lit_assign(&s, config, -*lit);
+				effort += f->n_clauses;
+				implied = !unit_reductions(&s, config);
+			}
+			else if (!lit_kept(kept, n_kept, *lit))
+				dropped = 1;
+		}
+
+		if (implied && !dropped) {
+			if (proof != NULL) proof_put(proof, 'd', lits, len);
+			s_set(base, c);
+			(*deleted)++;
+		}
+		else if (n_kept < n_lits) {
+			if (proof != NULL) {
+				proof_put(proof, 'a', kept, n_kept);
+				proof_put(proof, 'd', lits, len);
+			}
+			for (const int * lit = lits; *lit; lit++) {
+				if (lit_kept(kept, n_kept, *lit)) continue;
+				s_clear(f->clauses[*lit > 0 ? c : -c], abs(*lit));
+				s_clear(f->occurlists[*lit], c);
+			}
+			strengthened++;
+		}
+	}
+
+	if (strengthened > 0 || *deleted > 0)
+		formula_remove_clauses(f, base);
+
+	solver_clean(&s);
+	free(base);
+	free(config);
+	free(kept);
+	free(order);
+	return strengthened;
+}
+
+/* ==== Solver Functions ==== */
+void solver_init(solver * s, const formula * f)
+{
+	memset(s, 0, sizeof * s);
+	s->f = f;
+	s->ckpt_interval = 60;
+}
+
+void solver_clean(solver * s)
+{
+	free(s->root);
+	s->root = NULL;
+	xor_free(s->xors);
+	s->xors = NULL;
+	card_free(s->cards);
+	s->cards = NULL;
+}
+
+/* Searches for a model in which the assumptions hold, from
+ * scratch on every call, the way the settings of the solver
+ * tell. The counters are of this search alone, the time of
+ * parsing is left to whoever did it.
+ * Assumptions on variables beyond the formula are ignored.
+ */
+dpll_result solver_solve(solver * s, const int * assumptions, size_t n, bitstore ** model)
+{
+	const formula * f = s->f;
+	stats_t kept = s->stats;
+
+	s->stop_reason = NULL;
+	s->n_decisions = s->n_conflicts = s->n_flips = 0;
+	memset(&s->stats, 0, sizeof s->stats);
+	s->stats.progress_interval = kept.progress_interval;
+	s->stats.phase_time[PHASE_PARSE] = kept.phase_time[PHASE_PARSE];
+
+	// only the depth-first searcher knows the decisions leading to a node
+	if (s->proof != NULL) {
+		if (s->sls != SLS_NONE) {
+			s->stop_reason = "local search makes no proofs";
+			return TBD;
+		}
+		if (n > 0) {
+			s->stop_reason = "proofs cannot be made under assumptions";
+			return TBD;
+		}
+		s->depth_first = 1;
+	}
+
+	// components are split off, and conflicts jumped back from, by the depth-first searcher alone
+	if (s->decompose || s->backjump)
+		s->depth_first = 1;
+
+	// units implied by XORs make no lemmas of the proof
+	xor_free(s->xors);
+	s->xors = (s->gauss && s->proof == NULL) ? xor_find(f) : NULL;
+	if (s->xors != NULL) s->stats.xors = s->xors->n_rows;
+
+	card_free(s->cards);
+	s->cards = card_build(f);
+
+	free(s->root);
+	s->root = calloc(f->cfg_len, sizeof * s->root);
+	bitstore * nconf = s->root + f->cconf_len;
+	bitstore * pconf = nconf + f->olconf_len;
+
+	for (size_t i = 0; i < n; i++) {
+		int var = abs(assumptions[i]);
+		if (var == 0 || var > f->n_vars) continue;
+		if (is_s_set(assumptions[i] > 0 ? nconf : pconf, var))
+			return FAIL; // assumed both ways
+		lit_assign(s, s->root, assumptions[i]);
+	}
+
+	s->search_start = monotonic_sec();
+	s->stats.progress_last = s->search_start;
+
+	phase_begin(PHASE_SEARCH);
+	dpll_result result = lanes_probe(s, assumptions, n, model);
+	if (result == TBD && s->stop_reason == NULL)
+		result =
+			(s->sls != SLS_NONE) ? sls_solve(s, assumptions, n, model) :
+			s->depth_first ? dpll_depth(s, model) : dpll_breadth(s, model);
+	phase_end(s, PHASE_SEARCH);
+
+	if (result == SUCCESS && model != NULL && *model != NULL)
+		counters_extend_model(f, *model);
+
+	return result;
+}
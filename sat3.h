@@ -0,0 +1,258 @@
+/* DPLL SAT solver on bitmaps, as a library.
+ *
+ * A formula holds the clauses, and stays the same while it is
+ * being solved, so that any number of solvers can share it,
+ * each one in a thread of its own. A solver holds the state of
+ * one search over a formula, along with its settings.
+ *
+ *     formula * f = formula_new();
+ *     formula_read(f, fp);              // or formula_add_clause
+ *     solver s;
+ *     solver_init(&s, f);
+ *     bitstore * model = NULL;
+ *     switch (solver_solve(&s, assumptions, n, &model)) { ... }
+ *     free(model);
+ *     solver_clean(&s);
+ *     formula_free(f);
+ *
+ * Clauses can still be added to a formula in between solves,
+ * growing its variables and clauses as needed.
+ */
+#ifndef SAT3_H
+#define SAT3_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <signal.h>
+
+// Statistics are compiled in, unless NO_STATS is defined
+#ifndef NO_STATS
+#define STATS
+#endif
+
+// Width of the words in bitmaps, either 32 or 64
+#ifndef BITSTORE_BITS
+#define BITSTORE_BITS 32
+#endif
+
+#if BITSTORE_BITS == 64
+typedef uint64_t bitstore;
+#elif BITSTORE_BITS == 32
+typedef uint32_t bitstore;
+#else
+#error "BITSTORE_BITS must be 32 or 64"
+#endif
+
+#define sbitstore      (8 * sizeof(bitstore))
+#define bit(x)         ((bitstore) 1 << (x))
+#define mask(x, y)     ((x) & bit(y))
+#define is_s_set(s, i) mask((s)[(i) / sbitstore], (i) % sbitstore)
+#define s_set(s, i)    (s)[(i) / sbitstore] |= bit((i) % sbitstore)
+#define s_clear(s, i)  (s)[(i) / sbitstore] &= ~bit((i) % sbitstore)
+
+typedef
+enum dpll_result_tag {
+	TBD,
+	FAIL,
+	SUCCESS
+} dpll_result;
+
+typedef
+struct formula_tag {
+	unsigned int n_clauses;
+	unsigned int n_vars;
+							// variables and clauses are 1-indexed
+	bitstore ** clauses;	// 1s for existence of variables in modalities
+							// p/n modalities are at ith/-ith indices
+	bitstore ** occurlists; // 1s for occurrence in clauses
+							// occurrence of neg modalities in neg indices
+
+	int * lits;				// literals of all clauses one after another as read,
+							// each clause terminated with a 0
+	size_t * clause_offs;	// where each clause starts in lits, 1-indexed
+	size_t lits_len;
+	size_t lits_cap;
+
+	int n_lits;
+	double mean_occ_len;
+	unsigned int n_aux_vars;	// the last ones, added by preprocessing and left out of models
+
+	int * cards;			// at-most-one constraints, each as its literals then a 0
+	size_t cards_len;
+	unsigned int n_cards;
+	int * counters;			// sequential counters replaced by at-most-one constraints, each as
+							// its literals, a 0, the n - 1 literals of its counter, then a 0
+	size_t counters_len;
+
+	size_t cconf_len;
+	size_t olconf_len;
+	size_t cfg_len;
+	size_t cfg_size;
+
+	// room for growing, in rows of the bitmaps and words in each row
+	unsigned int clauses_cap;
+	unsigned int vars_cap;
+	size_t clause_words;	// words in occurlists rows, at least cconf_len
+	size_t var_words;		// words in clauses rows, at least olconf_len
+} formula;
+
+/* Searches can be bounded in wall-clock time, decisions,
+ * conflicts and memory. Zero limits are for no limit at all.
+ */
+typedef
+struct budget_tag {
+	double time;					// seconds since search_start
+	unsigned long long decisions;
+	unsigned long long conflicts;
+	unsigned long long flips;		// of local search
+	size_t memory;					// bytes, formula and searcher together
+} budget;
+
+typedef
+enum phase_tag {
+	PHASE_PARSE,
+	PHASE_REDUCE,	// dpll_step, the reductions
+	PHASE_CHOOSE,	// choosing the literal to decide
+	PHASE_SEARCH,	// the whole search, including the two above
+	N_PHASES
+} phase;
+
+typedef
+struct stats_tag {
+	unsigned long long propagations;	// literals propagated
+	unsigned long long pure_literals;	// of them, assigned by purity
+	unsigned long long consolidations;	// frontier compactions of breadth-first
+	unsigned long long components;		// counted by model counting
+	unsigned long long cache_hits;		// of them, found in the cache
+	unsigned long long splits;			// nodes split into components by decomposition
+	unsigned long long split_components;	// the components they were split into
+	unsigned long long backjumps;		// conflicts of depth-first search jumping over levels
+	unsigned long long jumped_levels;	// the levels they jumped over
+	unsigned int xors;					// found in the clauses, for Gauss-Jordan elimination
+	unsigned long long xor_units;		// literals implied by it
+	unsigned long long card_units;		// literals implied by cardinality constraints
+	size_t frontier;					// TBD configurations, the depth, or
+										// the unsatisfied clauses of local search
+	size_t peak_frontier;
+	double phase_time[N_PHASES];
+	double progress_interval;			// seconds in between progress lines, 0 for none
+	double progress_last;
+} stats_t;
+
+typedef struct drat_proof_tag drat_proof;
+typedef struct xor_system_tag xor_system;
+typedef struct card_system_tag card_system;
+typedef struct component_job_tag component_job;
+
+// Unsigned integer of any size, for model counts
+typedef
+struct bignum_tag {
+	uint32_t * limbs;	// least significant first
+	size_t len;			// 0 for zero
+	size_t cap;
+} bignum;
+
+/* Local search looks for models only, and never finds out
+ * that there are none, other than under the assumptions.
+ */
+typedef
+enum local_search_tag {
+	SLS_NONE,
+	SLS_PROBSAT,	// flips by break counts, exponentially less likely
+	SLS_WALKSAT		// flips a free variable, else a random or the least breaking
+} local_search;
+
+typedef
+struct solver_tag {
+	const formula * f;
+
+	// settings, all zero for the defaults
+	int depth_first;			// depth-first searcher instead of breadth-first
+	local_search sls;			// local search instead of either searcher
+	uint64_t seed;				// of the random choices of local search and probes
+	unsigned int probes;		// rounds of 64 random assignments tried before searching
+	size_t cache_size;			// bytes of the component cache of model counting, 256 MB if 0
+	unsigned int decompose;		// nodes of depth-first search in between two splits into
+								// components, 0 for never
+	int threads;				// solving the components of a split, 1 if 0
+	int gauss;					// XORs found in the clauses propagated by elimination
+	int backjump;				// depth-first search jumps over the levels conflicts owe nothing to
+	unsigned int chrono;		// jumps over more levels than this backtrack chronologically
+								// instead, 0 for no limit
+	budget limits;
+	const char * ckpt_path;		// where to save checkpoints, if at all
+	const char * resume_path;	// checkpoint to resume from, if any
+	double ckpt_interval;		// seconds in between two checkpoints, 60 if 0
+	drat_proof * proof;			// from proof_open, depth-first only
+	int (* terminate)(void * data);	// polled in between steps, stops if nonzero
+	void * terminate_data;
+
+	// state of the search
+	bitstore * root;			// configuration the search starts from
+	xor_system * xors;			// found at the start of the search, if gauss
+	card_system * cards;		// of the cardinality constraints of the formula, if any
+	int * reasons;				// clause each variable was implied by, 0 for none, if backjump
+	int conflict;				// clause the last unit reductions found empty, 0 for none
+	component_job * job;		// of the split this solver searches a component of, if any
+	double search_start;
+	double ckpt_last;
+	const char * stop_reason;	// why the search stopped with TBD
+	unsigned long long n_decisions;	// counters of the search,
+	unsigned long long n_conflicts;	// kept regardless of STATS for the budgets
+	unsigned long long n_flips;
+	stats_t stats;
+} solver;
+
+typedef
+enum searcher_tag {
+	BREADTH_FIRST,
+	DEPTH_FIRST
+} searcher;
+
+// Set by the signal handlers, stopping every search
+extern volatile sig_atomic_t interrupted;
+void on_signal(int sig);
+
+double monotonic_sec(void);
+
+formula * formula_new(void);
+void formula_free(formula * f);
+int formula_read(formula * f, FILE * fp);
+void formula_add_vars(formula * f, unsigned int n_vars);
+void formula_add_clause(formula * f, const int * lits, size_t n);
+unsigned int formula_break_symmetry(formula * f);
+void formula_canonical_hash(const formula * f, uint64_t hash[2]);
+unsigned int formula_find_cardinality(formula * f);
+unsigned int formula_vivify(formula * f, unsigned long long budget, drat_proof * proof, unsigned int * deleted);
+
+void solver_init(solver * s, const formula * f);
+void solver_clean(solver * s);
+dpll_result solver_solve(solver * s, const int * assumptions, size_t n, bitstore ** model);
+int ckpt_probe(solver * s);
+dpll_result solver_count(solver * s, const int * assumptions, size_t n, bignum * count);
+
+void bignum_init(bignum * a);
+void bignum_free(bignum * a);
+char * bignum_str(const bignum * a);
+
+drat_proof * proof_open(const char * path, int binary, const formula * f);
+void proof_close(drat_proof * pf);
+
+bitstore * copy_config(const formula * f, bitstore * config);
+int var_value(const formula * f, bitstore * config, int var);
+unsigned int verify_clauses(const formula * f, bitstore * config, const int * lits, size_t lits_len);
+unsigned int verify_model(const formula * f, bitstore * config);
+int read_model(const formula * f, FILE * fp, bitstore * config);
+void print_assignments(const formula * f, bitstore * config, FILE * stream);
+void print_competition(const formula * f, dpll_result result, bitstore * config, FILE * stream);
+void stats_print(const solver * s, const char * prefix);
+
+#ifdef PROFILE
+int trace_open(const char * path);
+void trace_close(void);
+void prof_init(void);
+void prof_print(const char * prefix);
+#endif
+
+#endif
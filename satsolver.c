@@ -449,14 +449,6 @@ void pure_variable_assignment(Formula * formula)
 	// retry_until == 0 means it was never set, so there were no pures inside, no need to retry
 }
 
-Formula * dpll(Formula * );
-
-Formula * dpll_with_unit(Formula * formula, int unit)
-{
-	unit_propagate(formula, unit);
-	return dpll(formula);
-}
-
 int unbiased_random(int n)
 {
 	int r;
@@ -538,30 +530,76 @@ void print_occurlists(Formula * formula)
 	puts("======= OCCURLS =======");
 }
 
-Formula * dpll(Formula * formula)
+// pending alternatives of the depth-first search, kept off the call stack
+typedef
+struct Alternative_tag
 {
-	if (consistent(formula)) return formula;
-	if (empty_clause_and_unit_propagate(formula) == 0)
-		return del_formula(formula);
-	if (consistent(formula)) return formula;
+	Formula * formula;	// formula as it was right before the decision
+	int unit;			// literal to try on it, opposite of the decision
+} Alternative;
+
+// reduces the formula, returns 1 if it is satisfied, -1 if it failed, 0 otherwise
+int dpll_reduce(Formula * formula)
+{
+	if (consistent(formula)) return 1;
+	if (empty_clause_and_unit_propagate(formula) == 0) return -1;
+	if (consistent(formula)) return 1;
 	pure_variable_assignment(formula);
-	if (consistent(formula)) return formula;
-
-	// choose a variable and recurse and recurse with its both modalities
-	// make a copy for first try, use the current one for the other if it comes to that
-	int var = choose_var_first(formula);
-	if (var == 0) {
-		printf("%d but no vars\n", formula->n_clauses);
-		print_clauses(formula);
-		print_occurlists(formula);
-		return formula;
+	if (consistent(formula)) return 1;
+	return 0;
+}
+
+Formula * dpll(Formula * formula)
+{
+	int capacity = 64;
+	int depth = 0;
+	Alternative * stack = malloc(capacity * sizeof * stack);
+
+	while (formula != NULL) {
+		int state = dpll_reduce(formula);
+		if (state == 1) break;
+
+		if (state == 0) {
+			// choose a variable and continue with its both modalities
+			// make a copy for first try, keep the current one for the other if it comes to that
+			int var = choose_var_first(formula);
+			if (var == 0) {
+				printf("%d but no vars\n", formula->n_clauses);
+				print_clauses(formula);
+				print_occurlists(formula);
+				break;
+			}
+
+			if (depth == capacity) {
+				capacity *= 2;
+				stack = realloc(stack, capacity * sizeof * stack);
+			}
+			stack[depth].formula = formula;
+			stack[depth].unit = -var;
+			depth++;
+
+			formula = copy_formula(formula);
+			unit_propagate(formula, var);
+			continue;
+		}
+
+		del_formula(formula);
+		if (depth == 0) {
+			formula = NULL;
+			break;
+		}
+
+		depth--;
+		formula = stack[depth].formula;
+		unit_propagate(formula, stack[depth].unit);
 	}
 
-	Formula * exhibitA = dpll_with_unit(copy_formula(formula), var);
-	if (exhibitA != NULL)
-		return exhibitA;
+	// satisfied ahead of trying the alternatives
+	while (depth > 0)
+		del_formula(stack[--depth].formula);
+	free(stack);
 
-	return dpll_with_unit(formula, -var);
+	return formula;
 }
 
 void print_formula(Formula * formula, FILE * stream)
@@ -295,40 +295,103 @@ int lit_choose(bitstore * config)
 	return 0;
 }
 
-bitstore * dpll_rec(bitstore * config)
+/* Explicit decision stack for the depth-first search:
+ * configs[k] is the reduced configuration right before the
+ * k-th decision, and choices[k] is the literal decided there.
+ * flipped[k] marks that its opposite is being tried.
+ */
+typedef
+struct dfs_stack_tag {
+	bitstore * configs;
+	int * choices;
+	char * flipped;
+	int depth;
+	int capacity;
+} dfs_stack;
+
+int cfg_len(void)
 {
-	if (!c_len_reductions(config)) {
-		free(config);
-		return NULL;
-	}
-	purity_reduction(config);
-	if (all_satisfied(config)) return config;
-
-	bitstore * configA = copy_config(config);
-	bitstore * configB = config;
+	return c_conf_size + 2 * ol_conf_size;
+}
 
-	int choice = lit_choose(config);
-	if (choice == 0) {
-		puts("This shouldn't happen.");
-		free(config);
-		return NULL;
-	}
+bitstore * dfs_config(dfs_stack * stack, int level)
+{
+	return stack->configs + level * cfg_len();
+}
 
-	lit_propagate(configA, choice);
-	configA = dpll_rec(configA);
-	if (configA) {
-		free(configB);
-		return configA;
-	}
+int dfs_reserve(dfs_stack * stack)
+{
+	if (stack->depth + 1 < stack->capacity) return 1;
+
+	int capacity = stack->capacity * 2;
+	bitstore * configs = realloc(stack->configs, capacity * cfg_size);
+	int * choices = realloc(stack->choices, capacity * sizeof * choices);
+	char * flipped = realloc(stack->flipped, capacity * sizeof * flipped);
+	if (configs != NULL) stack->configs = configs;
+	if (choices != NULL) stack->choices = choices;
+	if (flipped != NULL) stack->flipped = flipped;
+	if (configs == NULL || choices == NULL || flipped == NULL) return 0;
+
+	stack->capacity = capacity;
+	return 1;
+}
 
-	lit_propagate(configB, -choice);
-	return dpll_rec(configB);
+void dfs_push(dfs_stack * stack, int lit)
+{
+	bitstore * parent = dfs_config(stack, stack->depth);
+	bitstore * child = memcpy(parent + cfg_len(), parent, cfg_size);
+	stack->depth++;
+	lit_propagate(child, lit);
 }
 
 bitstore * dpll(void)
 {
-	bitstore * config = calloc(c_conf_size + 2 * ol_conf_size, sizeof * config);
-	return dpll_rec(config);
+	dfs_stack stack;
+	stack.capacity = 64;
+	stack.depth = 0;
+	stack.configs = calloc(stack.capacity, cfg_size);
+	stack.choices = malloc(stack.capacity * sizeof * stack.choices);
+	stack.flipped = malloc(stack.capacity * sizeof * stack.flipped);
+	bitstore * result = NULL;
+
+	while (stack.configs != NULL && stack.choices != NULL && stack.flipped != NULL) {
+		bitstore * config = dfs_config(&stack, stack.depth);
+
+		if (c_len_reductions(config)) {
+			purity_reduction(config);
+			if (all_satisfied(config)) {
+				result = copy_config(config);
+				break;
+			}
+
+			int choice = lit_choose(config);
+			if (choice != 0) {
+				if (!dfs_reserve(&stack)) {
+					fputs("Need more memory than system allows.\n", stderr);
+					break;
+				}
+				stack.choices[stack.depth] = choice;
+				stack.flipped[stack.depth] = 0;
+				dfs_push(&stack, choice);
+				continue;
+			}
+			puts("This shouldn't happen.");
+		}
+
+		// backtrack to the deepest decision whose opposite is not tried
+		while (stack.depth > 0 && stack.flipped[stack.depth - 1])
+			stack.depth--;
+		if (stack.depth == 0) break;
+
+		stack.depth--;
+		stack.flipped[stack.depth] = 1;
+		dfs_push(&stack, -stack.choices[stack.depth]);
+	}
+
+	free(stack.configs);
+	free(stack.choices);
+	free(stack.flipped);
+	return result;
 }
 
 void print_assignments(bitstore * config, FILE * stream)
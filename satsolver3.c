@@ -1,872 +1,1170 @@
+/* Command-line front end of the sat3 library, solving a
+ * DIMACS CNF file the way the flags below tell.
+ */
 #include <stdio.h>
 #include <stdlib.h>
-#include <stdint.h>
 #include <string.h>
+#include <ctype.h>
+#include <errno.h>
 #include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <utime.h>
+#include <dirent.h>
+#include <sys/stat.h>
 
-// Uncomment the following for debug messages
-// #define DEBUG
-
-#define BUFFERSIZE 1024
-#define EXPLPC 4
-
-// DO NOT CHANGE bitstore something else than uint32_t
-// count_bits and least_bit_pos are not ready for that
-typedef uint32_t bitstore;
-
-typedef
-struct pair_tag {
-	int a, b;
-} pair;
+#include "sat3.h"
 
+/* ==== Command-line Options ==== */
 typedef
-enum dpll_result_tag {
-	TBD,
-	FAIL,
-	SUCCESS
-} dpll_result;
-
-#define sbitstore      (8 * sizeof(bitstore))
-#define bit(x)         (1U << (x))
-#define mask(x, y)     ((x) & bit(y))
-#define is_s_set(s, i) mask((s)[(i) / sbitstore], (i) % sbitstore)
-#define s_set(s, i)    (s)[(i) / sbitstore] |= bit((i) % sbitstore)
-
-unsigned int n_clauses;
-unsigned int n_vars;
-						// variables and clauses are 1-indexed
-bitstore ** clauses;	// 1s for existence of variables in modalities
-						// p/n modalities are at ith/-ith indices
-bitstore ** occurlists; // 1s for occurrence in clauses
-						// occurrence of neg modalities in neg indices
-
-int n_lits;
-double mean_occ_len;
-
-size_t cconf_len;
-size_t olconf_len;
-size_t cfg_len;
-size_t cfg_size;
-
-/* ==== Function for Rounding Positive Doubles ==== */
-// This is to avoid complications of including math.h on Linux
-int round_pos(double d)
-{
-	return d + 0.5;
-}
-
-/* ==== Bit-operation Functions ==== */
-// https://stackoverflow.com/a/109025/2736228
-int count_bits(uint32_t i)
+struct options_tag {
+	const char * problem;	// input file in DIMACS CNF format
+	const char * solution;	// optional output file for the assignments
+	int depth_first;		// depth-first searcher instead of breadth-first
+	int backjump;			// jump back over the levels conflicts owe nothing to
+	unsigned int chrono;	// jumps over more levels backtrack chronologically, 0 for no limit
+	local_search sls;		// local search instead of either searcher
+	uint64_t seed;			// of local search and probes
+	unsigned int probes;	// rounds of 64 random assignments tried first
+	int count;				// count the models rather than find one
+	size_t cache_size;		// bytes of the component cache, 0 for the default
+	unsigned int decompose;	// nodes in between two splits into components, 0 for never
+	int symmetry;			// break the symmetries found before searching
+	int gauss;				// propagate the XORs found by Gauss-Jordan elimination
+	int cardinality;		// replace pairwise at-most-one groups with constraints
+	unsigned long long vivify;	// clauses checked by vivification before searching, 0 for none
+	const char * results;	// directory of the result cache, if any
+	size_t results_size;	// bytes of it, 0 for the default
+	const char * checkpoint;	// file to save checkpoints periodically
+	double checkpoint_interval;	// seconds in between checkpoints
+	const char * resume;	// checkpoint to resume the search from
+	budget limits;			// limits of the search, zero for none
+	int competition;		// output in the SAT competition format
+	int verify;				// verify the model before reporting it
+	int check;				// only check the solution file against the problem
+	const char * proof;		// file to write the DRAT proof to
+	int proof_text;			// DRAT proof in text rather than binary
+	double progress;		// seconds in between progress lines, 0 for none
+	const char * trace;		// file to write the Chrome trace to
+	const char * cubes;		// file of assumption cubes to solve one by one
+	int batch;				// problem is a batch of formulas, solution a directory
+	int jobs;				// threads solving the cubes, the batch or the components
+} options;
+
+void usage(const char * prog)
 {
-	i = i - ((i >> 1) & 0x55555555);
-	i = (i & 0x33333333) + ((i >> 2) & 0x33333333);
-	return (((i + (i >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+	fprintf(stderr, "Usage: %s [options] problem.cnf [solution.sol]\n", prog);
+	fprintf(stderr, "       %s --batch [options] DIR|LIST OUTDIR\n", prog);
+	fputs(
+		"Options:\n"
+		"  --breadth                  breadth-first search (default)\n"
+		"  --depth                    depth-first search\n"
+		"  --backjump                 search depth-first, jumping back over the decisions\n"
+		"                             conflicts do not follow from, unless writing a proof\n"
+		"  --chrono N                 backtrack chronologically instead of jumping over more\n"
+		"                             than N levels (default 100, 0 for never)\n"
+		"  --sls probsat|walksat      local search, which finds models but never proves there are none\n"
+		"  --seed N                   seed of the local search and probes (default 0)\n"
+		"  --probe N                  try N rounds of 64 random assignments before searching\n"
+		"  --count                    count the models, with a cache of components\n"
+		"  --cache-size MB            size of the component cache (default 256)\n"
+		"  --results DIR              look the formula up in the result cache in DIR first,\n"
+		"                             and cache its result there\n"
+		"  --results-size MB          size of the result cache (default 256)\n"
+		"  --xor                      find XORs in the clauses and propagate them by\n"
+		"                             Gauss-Jordan elimination, unless writing a proof\n"
+		"  --symmetry                 break the symmetries of the formula before searching\n"
+		"  --cardinality              replace groups of binary clauses encoding at-most-one\n"
+		"                             pairwise or as sequential counters with cardinality constraints\n"
+		"  --vivify N                 strengthen the clauses by unit propagation in a single pass\n"
+		"                             before searching, for up to N million clauses checked\n"
+		"  --decompose N              search depth-first, splitting every N-th node into its\n"
+		"                             independent components, searched one by one or in -j threads\n"
+		"  --checkpoint FILE          save the search state to FILE periodically\n"
+		"  --checkpoint-interval SEC  seconds in between checkpoints (default 60)\n"
+		"  --resume FILE              resume the search saved in FILE\n"
+		"  --time-limit SEC           give up after SEC seconds of search\n"
+		"  --decision-limit N         give up after N decisions\n"
+		"  --conflict-limit N         give up after N conflicts\n"
+		"  --flip-limit N             give up after N flips of local search\n"
+		"  --memory-limit MB          give up before using more than MB megabytes\n"
+		"  --competition              print the result in the SAT competition format\n"
+		"  --verify                   verify the model against the formula before reporting it\n"
+		"  --check                    do not solve, check solution.sol against the formula\n"
+		"  --proof FILE               write a binary DRAT proof to FILE, searching depth-first\n"
+		"  --proof-text               write the DRAT proof in text instead\n"
+		"  --progress SEC             print the search statistics every SEC seconds\n"
+		"  --trace FILE               write a Chrome trace of the search, if built with PROFILE\n"
+		"  --cubes FILE               solve the formula under each cube of assumptions in FILE\n"
+		"  --batch                    solve the .cnf files of DIR, or the ones listed in LIST,\n"
+		"                             writing the results and summary.csv to OUTDIR\n"
+		"  -j, --jobs N               threads solving the cubes, the batch or the components (default 1)\n"
+		"Exits with 10 if satisfiable, 20 if unsatisfiable, 0 if unknown.\n",
+		stderr);
 }
 
-// https://stackoverflow.com/a/757266/2736228
-uint8_t least_bit_pos(uint32_t v)
+int parse_options(int argc, char const *argv[], options * opts)
 {
-	static const uint8_t debruijnbitposition2[32] = {
-		0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
-		31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
-	};
-	return debruijnbitposition2[((uint32_t)((v & (-v)) * 0x077cb531u)) >> 27];
-}
+	int n_positional = 0;
+	memset(opts, 0, sizeof * opts);
+	opts->checkpoint_interval = 60;
+	opts->jobs = 1;
+	opts->chrono = 100;
+
+	for (int i = 1; i < argc; i++) {
+		// options taking a value expect it as the next argument
+		const char * value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+		if (strcmp(argv[i], "--depth") == 0)
+			opts->depth_first = 1;
+		else if (strcmp(argv[i], "--backjump") == 0)
+			opts->backjump = 1;
+		else if (strcmp(argv[i], "--chrono") == 0 && value != NULL)
+			opts->chrono = strtoul(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--breadth") == 0)
+			opts->depth_first = 0;
+		else if (strcmp(argv[i], "--sls") == 0 && value != NULL) {
+			if (strcmp(value, "probsat") == 0) opts->sls = SLS_PROBSAT;
+			else if (strcmp(value, "walksat") == 0) opts->sls = SLS_WALKSAT;
+			else return 0;
+			i++;
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && value != NULL)
+			opts->seed = strtoull(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--probe") == 0 && value != NULL)
+			opts->probes = strtoul(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--count") == 0)
+			opts->count = 1;
+		else if (strcmp(argv[i], "--cache-size") == 0 && value != NULL)
+			opts->cache_size = atof(argv[++i]) * (1 << 20);
+		else if (strcmp(argv[i], "--results") == 0 && value != NULL)
+			opts->results = argv[++i];
+		else if (strcmp(argv[i], "--results-size") == 0 && value != NULL)
+			opts->results_size = atof(argv[++i]) * (1 << 20);
+		else if (strcmp(argv[i], "--xor") == 0)
+			opts->gauss = 1;
+		else if (strcmp(argv[i], "--symmetry") == 0)
+			opts->symmetry = 1;
+		else if (strcmp(argv[i], "--cardinality") == 0)
+			opts->cardinality = 1;
+		else if (strcmp(argv[i], "--vivify") == 0 && value != NULL)
+			opts->vivify = atof(argv[++i]) * 1e6;
+		else if (strcmp(argv[i], "--decompose") == 0 && value != NULL)
+			opts->decompose = strtoul(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--competition") == 0)
+			opts->competition = 1;
+		else if (strcmp(argv[i], "--verify") == 0)
+			opts->verify = 1;
+		else if (strcmp(argv[i], "--check") == 0)
+			opts->check = 1;
+		else if (strcmp(argv[i], "--proof") == 0 && value != NULL)
+			opts->proof = argv[++i];
+		else if (strcmp(argv[i], "--proof-text") == 0)
+			opts->proof_text = 1;
+		else if (strcmp(argv[i], "--checkpoint") == 0 && value != NULL)
+			opts->checkpoint = argv[++i];
+		else if (strcmp(argv[i], "--checkpoint-interval") == 0 && value != NULL)
+			opts->checkpoint_interval = atof(argv[++i]);
+		else if (strcmp(argv[i], "--resume") == 0 && value != NULL)
+			opts->resume = argv[++i];
+		else if (strcmp(argv[i], "--time-limit") == 0 && value != NULL)
+			opts->limits.time = atof(argv[++i]);
+		else if (strcmp(argv[i], "--decision-limit") == 0 && value != NULL)
+			opts->limits.decisions = strtoull(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--conflict-limit") == 0 && value != NULL)
+			opts->limits.conflicts = strtoull(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--flip-limit") == 0 && value != NULL)
+			opts->limits.flips = strtoull(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--memory-limit") == 0 && value != NULL)
+			opts->limits.memory = atof(argv[++i]) * (1 << 20);
+		else if (strcmp(argv[i], "--progress") == 0 && value != NULL)
+			opts->progress = atof(argv[++i]);
+		else if (strcmp(argv[i], "--trace") == 0 && value != NULL)
+			opts->trace = argv[++i];
+		else if (strcmp(argv[i], "--batch") == 0)
+			opts->batch = 1;
+		else if (strcmp(argv[i], "--cubes") == 0 && value != NULL)
+			opts->cubes = argv[++i];
+		else if ((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) && value != NULL)
+			opts->jobs = atoi(argv[++i]);
+		else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+			fprintf(stderr, "Unknown option %s\n", argv[i]);
+			return 0;
+		}
+		else switch (n_positional++) {
+			case 0: opts->problem = argv[i]; break;
+			case 1: opts->solution = argv[i]; break;
+			default: return 0;
+		}
+	}
 
-/* ==== Initialization and Clean-up Functions ==== */
-void init_globals(void) {
-	cconf_len = n_clauses / sbitstore + 1;
-	olconf_len = n_vars / sbitstore + 1;
-	cfg_len = cconf_len + 2 * olconf_len;
-	cfg_size = cfg_len * sizeof(bitstore);
+	return opts->problem != NULL && opts->jobs > 0
+		&& (!opts->check || opts->solution != NULL)
+		&& (!opts->batch || opts->solution != NULL);
 }
 
-void init_formula(void)
+// Settings of a solver, the same for every formula and cube
+void solver_setup(solver * s, const options * opts)
 {
-	init_globals();
-
-	clauses = malloc((2 * n_clauses + 1) * sizeof * clauses);
-	clauses += n_clauses;
-	clauses[0] = NULL;
-
-	occurlists = malloc((2 * n_vars + 1) * sizeof * occurlists);
-	occurlists += n_vars;
-	occurlists[0] = NULL;
-
-	for (int i = 1; i <= n_clauses; i++) {
-		clauses[i] = calloc(olconf_len, sizeof * clauses[i]);
-		clauses[-i] = calloc(olconf_len, sizeof * clauses[i]);
-	}
-
-	for (int i = 1; i <= n_vars; i++) {
-		occurlists[i] = calloc(cconf_len, sizeof * occurlists[i]);
-		occurlists[-i] = calloc(cconf_len, sizeof * occurlists[-i]);
-	}
+	s->depth_first = opts->depth_first;
+	s->sls = opts->sls;
+	s->seed = opts->seed;
+	s->probes = opts->probes;
+	s->cache_size = opts->cache_size;
+	s->decompose = opts->decompose;
+	s->gauss = opts->gauss;
+	s->backjump = opts->backjump;
+	s->chrono = opts->chrono;
+	s->limits = opts->limits;
+	s->stats.progress_interval = opts->progress;
 }
 
-void clean_formula(void)
+// Clauses of the formula as read, for models to be verified against after preprocessing
+int * lits_as_read(const formula * f)
 {
-	for (int i = 1; i <= n_clauses; i++) {
-		free(clauses[i]);
-		free(clauses[-i]);
-	}
-
-	for (int i = 1; i <= n_vars; i++) {
-		free(occurlists[i]);
-		free(occurlists[-i]);
-	}
-
-	free(clauses - n_clauses);
-	free(occurlists - n_vars);
+	return memcpy(malloc(f->lits_len * sizeof * f->lits + 1), f->lits, f->lits_len * sizeof * f->lits);
 }
 
-/* ==== Functions for Reading and Populating Formula ==== */
-void lits_add(int lit, int i_clause)
+// Vivifies the clauses within the budget of the options, if any, quietly unless given a prefix
+void vivify(formula * f, const options * opts, drat_proof * proof, const char * prefix)
 {
-	if (lit > 0) s_set(clauses[i_clause], lit);
-	else         s_set(clauses[-i_clause], -lit);
-	s_set(occurlists[lit], i_clause);
-	n_lits++;
+	if (opts->vivify == 0) return;
+
+	double start = monotonic_sec();
+	int n_lits = f->n_lits;
+	unsigned int deleted;
+	unsigned int strengthened = formula_vivify(f, opts->vivify, proof, &deleted);
+	if (prefix != NULL)
+		printf("%sVivification: %u clauses strengthened, %u deleted, %d literals removed in %fs\n", prefix,
+			strengthened, deleted, n_lits - f->n_lits, monotonic_sec() - start);
 }
 
-int read(FILE * fp)
+// Checks a solution file against the formula, rather than solving it
+int check_solution(const formula * f, const char * path)
 {
-	char buffer[BUFFERSIZE];
-
-	while (fgets(buffer, BUFFERSIZE, fp) != NULL)
-	switch (*buffer) {
-		case 'c': // a comment
-			break;
-		case 'p': // the spec
-			if (sscanf(buffer, "p cnf %u %u", &n_vars, &n_clauses) != 2) {
-				fputs("Error at the spec line.\n", stderr);
-				return 0;
-			}
-			goto spec_read;
-		default:
-			fputs("Spec line missing, malformed file.\n", stderr);
-			return 0;
+	FILE * fp = fopen(path, "r");
+	if (fp == NULL) {
+		perror("Error opening solution file.");
+		return -1;
 	}
-spec_read:
 
-	init_formula();
+	bitstore * config = malloc(f->cfg_size);
+	int ok = read_model(f, fp, config);
+	fclose(fp);
 
-	unsigned int i_clause = 0;
-	while (i_clause < n_clauses && fgets(buffer, BUFFERSIZE, fp) != NULL) {
-		if (*buffer == 'c') { /* a comment */ }
-		else { // a clause
-			int lit;
-			char * token = strtok(buffer, " ");
-			i_clause++;
-
-			while (token != NULL) {
-				lit = atoi(token);
-				if (lit == 0) break;
-
-				lits_add(lit, i_clause);
-				token = strtok(NULL, " ");
-			}
-		}
+	if (!ok) {
+		fputs("Solution couldn't be read\n", stderr);
+		free(config);
+		return -1;
 	}
-	mean_occ_len = (double) n_lits / n_vars;
 
-	if (i_clause != n_clauses) {
-		fprintf(stderr, "%u/%u clauses are missing.\n", n_clauses - i_clause, n_clauses);
-		return 0;
-	}
+	unsigned int failed = verify_model(f, config);
+	free(config);
 
-	if (ferror(fp)) {
-		perror("Error reading file.");
-		return 0;
+	if (failed) {
+		printf("Clause %u is not satisfied!\n", failed);
+		return 1;
 	}
 
-	return 1;
+	puts("Assignment is satisfying!");
+	return 0;
 }
 
-/* ==== Configuration Functions ==== */
-/* Configurations are descriptors of states with
- * minimum memory footprint. They store:
- *   - satisfied clause information
- *   - negative variable assignments
- *   - positive variable assignments
- * The actual formula state can be recovered using
- * the initial formula that stays constant, and using
- * configurations.
- *
- * Specification:
- *   - cconf, an array of bitstores where 1 in an index
- *            means that the corresponding (c)lause is
- *            satisfied
- *   - nconf, an array of bitstores where 1 in an index
- *            means that the corresponding literal is
- *            fixed to be (n)egative, i.e. False
- *   - pconf, similar to nconf
+/* ==== Result Cache Functions ==== */
+/* Results are kept on disk across runs, one file per formula in the
+ * directory of the cache, named by the canonical hash of the formula
+ * as read, the same however its clauses are ordered. A file has the
+ * numbers of variables and clauses in a comment line, followed by the
+ * result in the SAT competition format. Models from the cache are
+ * verified before being used, so that a collision of hashes cannot
+ * make a wrong one, UNSAT results are left to the 128 bits of the
+ * hash. Files are touched whenever used, and the least recently used
+ * ones are evicted by their modification times, beyond the size.
  */
-bitstore * copy_config(bitstore * config)
-{
-	bitstore * cfg = malloc(cfg_size);
-	return memcpy(cfg, config, cfg_size);
-}
+#define RESULTS_SIZE (256ULL << 20)	// bytes, unless the options tell
 
-/* Bit-storage makes some operations a breeze
- * and this is one of its finest depictions.
- */
-void lit_propagate(bitstore * cconf, int lit)
+typedef
+struct result_key_tag {
+	uint64_t hash[2];
+	unsigned int n_vars;	// of the formula as read, before any preprocessing
+	unsigned int n_clauses;
+} result_key;
+
+typedef
+struct result_file_tag {
+	char * path;
+	time_t mtime;
+	off_t size;
+} result_file;
+
+void result_key_of(const formula * f, result_key * key)
 {
-	bitstore * occurlist = occurlists[lit];
-	for (int i = 0; i < cconf_len; i++)
-		cconf[i] |= occurlist[i];
+	formula_canonical_hash(f, key->hash);
+	key->n_vars = f->n_vars;
+	key->n_clauses = f->n_clauses;
 }
 
-void var_assign(bitstore * config, int var, int ispos)
+char * result_path(const char * dir, const result_key * key)
 {
-	bitstore * cconf = config;
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
-
-	bitstore * xconf;
-	int lit;
-
-	if (ispos) xconf = pconf, lit = var;
-	else       xconf = nconf, lit = -var;
-	
-	s_set(xconf, var);
-	lit_propagate(cconf, lit);
+	char * path = malloc(strlen(dir) + 40);
+	sprintf(path, "%s/%016llx%016llx.res", dir,
+		(unsigned long long) key->hash[0], (unsigned long long) key->hash[1]);
+	return path;
 }
 
-void lit_assign(bitstore * config, int lit)
+/* Looks the formula up in the cache. Results in SUCCESS with its
+ * model put into model, FAIL, or TBD if it is not in there.
+ */
+dpll_result result_lookup(const char * dir, const formula * f, const result_key * key, bitstore ** model)
 {
-	bitstore * cconf = config;
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
+	char * path = result_path(dir, key);
+	FILE * fp = fopen(path, "r");
+	dpll_result result = TBD;
+	unsigned int n_vars, n_clauses;
+	char line[32];
 
-	bitstore * xconf;
-	int var;
+	if (fp == NULL) {
+		free(path);
+		return TBD;
+	}
 
-	if (lit > 0) xconf = pconf, var = lit;
-	else         xconf = nconf, var = -lit;
+	if (fscanf(fp, "c sat3 %u %u\n", &n_vars, &n_clauses) == 2
+		&& n_vars == key->n_vars && n_clauses == key->n_clauses
+		&& fgets(line, sizeof line, fp) != NULL) {
+		if (strcmp(line, "s UNSATISFIABLE\n") == 0)
+			result = FAIL;
+		else if (strcmp(line, "s SATISFIABLE\n") == 0) {
+			*model = malloc(f->cfg_size);
+			if (read_model(f, fp, *model) && verify_model(f, *model) == 0)
+				result = SUCCESS;
+			else {
+				free(*model);
+				*model = NULL;
+			}
+		}
+	}
+	fclose(fp);
 
-	s_set(xconf, var);
-	lit_propagate(cconf, lit);
-}
+	// a stale entry is of no use to anyone, a used one is the most recent
+	if (result == TBD) unlink(path);
+	else               utime(path, NULL);
 
-int clause_length(bitstore * config, int clause_i)
-{
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
-	bitstore * pclause = clauses[clause_i];
-	bitstore * nclause = clauses[-clause_i];
-
-	int c = 0;
-	for (int i = 0; i < olconf_len; i++) {
-		/* Count the positive literals in clauses which (&)
-		 * are not (~) set to its negative.
-		 * Vice versa.
-		 */
-		c += count_bits(pclause[i] & ~nconf[i]);
-		c += count_bits(nclause[i] & ~pconf[i]);
-	}
-
-	return c;
+	free(path);
+	return result;
 }
 
-unsigned int e_occurrence_unsat(bitstore * cconf, int lit)
+int result_file_cmp(const void * a, const void * b)
 {
-	bitstore * occurlist = occurlists[lit];
-	for (int i = 0; i < cconf_len; i++)
-		if (occurlist[i] & ~cconf[i])
-			// Occurrences that are (&) not (~) satisfied.
-			return 1U;
-	return 0U;
+	const result_file * x = a;
+	const result_file * y = b;
+	return (x->mtime > y->mtime) - (x->mtime < y->mtime);
 }
 
-unsigned int var_state(bitstore * cconf, int var)
+// Evicts the least recently used files, until the rest fit in the size
+void result_evict(const char * dir, size_t size)
 {
-	return
-		e_occurrence_unsat(cconf, -var) << 1 |
-		e_occurrence_unsat(cconf, var);
-}
+	DIR * d = opendir(dir);
+	if (d == NULL) return;
+
+	result_file * files = NULL;
+	size_t n = 0, cap = 0, total = 0;
+	struct dirent * entry;
+
+	while ((entry = readdir(d)) != NULL) {
+		size_t len = strlen(entry->d_name);
+		if (len < 4 || strcmp(entry->d_name + len - 4, ".res") != 0) continue;
+
+		char * path = malloc(strlen(dir) + len + 2);
+		struct stat st;
+		sprintf(path, "%s/%s", dir, entry->d_name);
+		if (stat(path, &st) != 0) {
+			free(path);
+			continue;
+		}
 
-unsigned int ass_state(bitstore * nconf, bitstore * pconf, int var)
-{
-	return
-		!!is_s_set(nconf, var) << 1 |
-		!!is_s_set(pconf, var);
-}
+		if (n == cap) files = realloc(files, (cap = cap ? 2 * cap : 64) * sizeof * files);
+		files[n++] = (result_file) { path, st.st_mtime, st.st_size };
+		total += st.st_size;
+	}
+	closedir(d);
 
-void print_assignments(bitstore * config, FILE * stream)
-{
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
-
-	for (int i = 1; i <= n_vars; i++) {
-		switch (ass_state(nconf, pconf, i)) {
-			case 0b00:
-#if DEBUG // we always depict this case as assigned to 1
-				printf("Var #%d is unset\n", i);
-#endif
-			case 0b01:
-				fprintf(stream, "%d 1\n", i);
-				break;
-			case 0b11:
-#if DEBUG // we depict this case as assigned to 0, only if not DEBUG
-				printf("Var #%d is set for both\n", i);
-				break;
-#endif
-			case 0b10:
-				fprintf(stream, "%d 0\n", i);
-				break;
-		}
+	qsort(files, n, sizeof * files, result_file_cmp);
+	for (size_t i = 0; i < n; i++) {
+		if (total > size && unlink(files[i].path) == 0)
+			total -= files[i].size;
+		free(files[i].path);
 	}
+	free(files);
 }
 
-int lit_occurrence_count(bitstore * cconf, int lit)
+/* Stores a result into the cache, written to a temporary file and
+ * renamed into place, for the runs sharing the cache to never see
+ * half of one.
+ */
+void result_store(const char * dir, size_t size, const formula * f, const result_key * key,
+	dpll_result result, bitstore * model)
 {
-	int c = 0;
-	bitstore * occurlist = occurlists[lit];
+	if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+		perror("Result cache couldn't be made");
+		return;
+	}
 
-	for (int i = 0; i < cconf_len; i++)
-		// Count occurrences that are (&) not (~) satisfied.
-		c += count_bits(occurlist[i] & ~cconf[i]);
-	return c;
-}
+	char * tmp_path = malloc(strlen(dir) + 16);
+	sprintf(tmp_path, "%s/.res.XXXXXX", dir);
+	int fd = mkstemp(tmp_path);
+	FILE * fp = (fd < 0) ? NULL : fdopen(fd, "w");
+	if (fp == NULL) {
+		perror("Result couldn't be cached");
+		free(tmp_path);
+		return;
+	}
 
-int var_occurrence_count(bitstore * cconf, int var)
-{
-	return
-		lit_occurrence_count(cconf, var) +
-		lit_occurrence_count(cconf, -var);
+	fprintf(fp, "c sat3 %u %u\n", key->n_vars, key->n_clauses);
+	print_competition(f, result, model, fp);
+
+	char * path = result_path(dir, key);
+	if ((ferror(fp) | fclose(fp)) || rename(tmp_path, path) != 0) {
+		perror("Result couldn't be cached");
+		unlink(tmp_path);
+	}
+	else
+		result_evict(dir, size ? size : RESULTS_SIZE);
+
+	free(path);
+	free(tmp_path);
 }
 
-int sat_count(bitstore * cconf)
+/* ==== Cube Functions ==== */
+/* Cubes are conjunctions of literals to assume, one per line
+ * terminated with a 0, optionally prefixed with an 'a' as in
+ * iCNF. The formula is read once, and every cube is solved by
+ * a solver of its own from a fresh root over it, with the
+ * budgets applying to each cube on its own. Threads take the
+ * next cube as they are done with one, and report it at once.
+ */
+typedef
+struct cube_list_tag {
+	int * lits;			// literals of all cubes, each terminated with a 0
+	size_t lits_len;
+	size_t lits_cap;
+	size_t * offs;		// where each cube starts in lits
+	size_t n_cubes;
+	size_t offs_cap;
+} cube_list;
+
+typedef
+struct cube_job_tag {
+	const formula * f;
+	const options * opts;
+	const cube_list * cubes;
+	FILE * fw;				// models of the satisfiable cubes, if any
+	const char * prefix;
+	const int * read;		// clauses of the formula as read, for verifying
+	size_t read_len;
+
+	pthread_mutex_t lock;	// guards the rest, and the output
+	size_t next;			// cube to be taken next
+	size_t counts[3];		// cubes by dpll_result
+} cube_job;
+
+void cubes_push(cube_list * cubes, int lit)
 {
-	int c = 0;
-	for (int i = 0; i < cconf_len; i++)
-		c += count_bits(cconf[i]);
-	return c;
+	if (cubes->lits_len == cubes->lits_cap) {
+		cubes->lits_cap = cubes->lits_cap ? 2 * cubes->lits_cap : 1024;
+		cubes->lits = realloc(cubes->lits, cubes->lits_cap * sizeof * cubes->lits);
+	}
+	cubes->lits[cubes->lits_len++] = lit;
 }
 
-int all_satisfied(bitstore * cconf)
+void cubes_begin(cube_list * cubes)
 {
-	return sat_count(cconf) == n_clauses;
+	if (cubes->n_cubes == cubes->offs_cap) {
+		cubes->offs_cap = cubes->offs_cap ? 2 * cubes->offs_cap : 64;
+		cubes->offs = realloc(cubes->offs, cubes->offs_cap * sizeof * cubes->offs);
+	}
+	cubes->offs[cubes->n_cubes++] = cubes->lits_len;
 }
 
-int get_unit(bitstore * config, int clause_i)
+int read_cubes(const char * path, cube_list * cubes)
 {
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
-	bitstore * pclause = clauses[clause_i];
-	bitstore * nclause = clauses[-clause_i];
-	
-	bitstore temp;
-	for (int i = 0; i < olconf_len; i++) {
-		/* Negative literals in a clause that are (&)
-		 * not (~) set to its positive.
-		 * Vice versa.
-		 */
-		temp = nclause[i] & ~pconf[i];
-		if (temp) return -(least_bit_pos(temp) + i * sbitstore);
-
-		temp = pclause[i] & ~nconf[i];
-		if (temp) return least_bit_pos(temp) + i * sbitstore;
+	FILE * fp = fopen(path, "r");
+	if (fp == NULL) {
+		perror("Error opening cubes file.");
+		return 0;
 	}
 
-	return 0;
-}
+	int c, lit, open = 0;
+	memset(cubes, 0, sizeof * cubes);
 
-/* Reductions arising from clause length, which are:
- *   - empty clause indicating impossibility to satisfy
- *   - unit clause calling for literal assignment/propagation
- */
-int c_len_reductions(bitstore * config)
-{
-	bitstore * cconf = config;
-	int last_edit = n_clauses + 1;
-
-	for (int i = 1; i != last_edit; i++) {
-		if (i == n_clauses + 1) i = 1;
-		if (is_s_set(cconf, i)) continue;
-
-		switch (clause_length(config, i)) {
-			case 0: return 0;
-			case 1:
-				lit_assign(config, get_unit(config, i));
-				last_edit = (i == 1) ? (n_clauses + 1) : i;
+	while ((c = getc(fp)) != EOF) {
+		if (c == 'c') { // a comment
+			while ((c = getc(fp)) != EOF && c != '\n');
+			continue;
 		}
+		if (c == 'a' || isspace(c)) continue;
+
+		ungetc(c, fp);
+		if (fscanf(fp, "%d", &lit) != 1) {
+			fputs("Malformed cubes file.\n", stderr);
+			fclose(fp);
+			return 0;
+		}
+
+		if (!open) cubes_begin(cubes), open = 1;
+		cubes_push(cubes, lit);
+		if (lit == 0) open = 0;
 	}
+	if (open) cubes_push(cubes, 0); // the last one may lack its 0
 
+	fclose(fp);
 	return 1;
 }
 
-void purity_reduction(bitstore * config)
+void * cube_worker(void * arg)
 {
-	bitstore * cconf = config;
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
-	int last_edit = n_vars + 1;
-
-	for (int i = 1; i != last_edit; i++) {
-		if (i == n_vars + 1) i = 1;
-		if (is_s_set(pconf, i) || is_s_set(nconf, i)) continue;
-
-		switch (var_state(cconf, i)) {
-			case 0b01:
-				var_assign(config, i, 1);
-				last_edit = (i == 1) ? (n_vars + 1) : i;
-				break;
-			case 0b10:
-				var_assign(config, i, 0);
-				last_edit = (i == 1) ? (n_vars + 1) : i;
-				break;
-			case 0b00:
-				var_assign(config, i, 1);
-				break;
+	cube_job * job = arg;
+	const options * opts = job->opts;
+	const char * results[] = { "UNKNOWN", "UNSAT", "SAT" };
+	solver s;
+
+	solver_init(&s, job->f);
+	solver_setup(&s, opts);
+
+	for (;;) {
+		pthread_mutex_lock(&job->lock);
+		size_t i = job->next++;
+		pthread_mutex_unlock(&job->lock);
+		if (i >= job->cubes->n_cubes) break;
+
+		const int * cube = job->cubes->lits + job->cubes->offs[i];
+		size_t n = 0;
+		while (cube[n]) n++;
+
+		bitstore * model = NULL;
+		double start = monotonic_sec();
+		dpll_result result = solver_solve(&s, cube, n, &model);
+		double elapsed = monotonic_sec() - start;
+
+		if (result == SUCCESS && opts->verify && verify_clauses(job->f, model, job->read, job->read_len)) {
+			s.stop_reason = "model failed verification";
+			result = TBD;
 		}
+
+		pthread_mutex_lock(&job->lock);
+		job->counts[result]++;
+		printf("%scube %zu: %s in %fs, %llu %s", job->prefix,
+			i + 1, results[result], elapsed,
+			s.sls ? s.n_flips : s.n_decisions, s.sls ? "flips" : "decisions");
+		if (result == TBD) printf(" (%s)", s.stop_reason);
+		putchar('\n');
+		fflush(stdout);
+		if (result == SUCCESS && job->fw != NULL) {
+			fprintf(job->fw, "c cube %zu\n", i + 1);
+			print_competition(job->f, result, model, job->fw);
+		}
+		pthread_mutex_unlock(&job->lock);
+
+		free(model);
 	}
+
+	solver_clean(&s);
+	return NULL;
 }
 
-// UNUSED first non-determined variable
-int var_choose_first(bitstore * config)
+/* Solves every cube, returning the exit code: 10 if any of them
+ * is satisfiable, 20 if all of them are unsatisfiable, 0 otherwise.
+ */
+int solve_cubes(const formula * f, const int * read, size_t read_len, const options * opts, FILE * fw)
 {
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
-
-	for (int i = 1; i <= n_vars; i++)
-		if (ass_state(nconf, pconf, i) == 0b00)
-			return i;
+	cube_list cubes;
+	if (!read_cubes(opts->cubes, &cubes)) return -1;
+
+	cube_job job = { f, opts, &cubes, fw, opts->competition ? "c " : "", read, read_len };
+	pthread_mutex_init(&job.lock, NULL);
+
+	int n_threads = (opts->jobs < cubes.n_cubes) ? opts->jobs : cubes.n_cubes;
+	pthread_t * threads = malloc(n_threads * sizeof * threads);
+	for (int t = 1; t < n_threads; t++)
+		pthread_create(&threads[t], NULL, cube_worker, &job);
+	cube_worker(&job);
+	for (int t = 1; t < n_threads; t++)
+		pthread_join(threads[t], NULL);
+
+	printf("%sCubes: %zu satisfiable, %zu unsatisfiable, %zu unknown\n", job.prefix,
+		job.counts[SUCCESS], job.counts[FAIL], job.counts[TBD]);
+
+	pthread_mutex_destroy(&job.lock);
+	free(threads);
+	free(cubes.lits);
+	free(cubes.offs);
+
+	if (job.counts[SUCCESS]) return 10;
+	if (cubes.n_cubes && job.counts[FAIL] == cubes.n_cubes) return 20;
 	return 0;
 }
 
-// UNUSED last non-determined variable
-int var_choose_last(bitstore * config)
-{
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
+/* ==== Batch Functions ==== */
+/* Batches are many formulas solved in one process, given as a
+ * directory of .cnf files or a file listing one path per line.
+ * Threads take the next formula as they are done with one, and
+ * read and solve it with a formula and solver of their own. The
+ * result of each, in the competition format along with its model,
+ * goes to a .out file named after it in the output directory, and
+ * a line for each goes to summary.csv there, in the input order.
+ */
+typedef
+struct batch_item_tag {
+	char * path;
+	dpll_result result;
+	const char * reason;	// stop reason, or why it couldn't be solved
+	double time;
+	unsigned long long decisions;
+	unsigned long long conflicts;
+	unsigned long long flips;
+	int error;				// couldn't be read or written
+} batch_item;
 
-	for (int i = n_vars; i > 0; i++)
-		if (ass_state(nconf, pconf, i) == 0b00)
-			return i;
-	return 0;
+typedef
+struct batch_job_tag {
+	const options * opts;
+	const char * out_dir;
+	batch_item * items;
+	size_t n_items;
+	const char * prefix;
+
+	pthread_mutex_t lock;	// guards the rest, and the output
+	size_t next;			// item to be taken next
+	size_t counts[3];		// items by dpll_result
+	size_t errors;
+} batch_job;
+
+int path_cmp(const void * a, const void * b)
+{
+	return strcmp(((const batch_item *) a)->path, ((const batch_item *) b)->path);
 }
 
-// UNUSED most frequent non-determined variable
-int var_choose_max_occur(bitstore * config)
+void batch_push(batch_item ** items, size_t * n, size_t * cap, char * path)
 {
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
-
-	int max = 0;
-	int max_i = 0;
-
-	for (int i = 1; i <= n_vars; i++) {
-		if (ass_state(nconf, pconf, i) == 0b00) {
-			int n_occ = var_occurrence_count(config, i);
-			if (n_occ > max) {
-				max = n_occ;
-				max_i = i;
-			}
-		}
+	if (*n == *cap) {
+		*cap = *cap ? 2 * *cap : 64;
+		*items = realloc(*items, *cap * sizeof ** items);
 	}
-
-	return max_i;
+	memset(*items + *n, 0, sizeof ** items);
+	(*items)[(*n)++].path = path;
 }
 
-// UNUSED least frequent non-determined variable
-int var_choose_min_occur(bitstore * config)
+// Takes the .cnf files of a directory in name order, or the paths listed in a file
+batch_item * read_batch(const char * input, size_t * n_items)
 {
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
-
-	int min = 2 * n_clauses;
-	int min_i = 0;
-
-	for (int i = 1; i <= n_vars; i++) {
-		if (ass_state(nconf, pconf, i) == 0b00) {
-			int n_occ = var_occurrence_count(config, i);
-			if (n_occ < min) {
-				min = n_occ;
-				min_i = i;
-			}
-		}
+	batch_item * items = NULL;
+	size_t n = 0, cap = 0;
+	struct stat st;
+
+	if (stat(input, &st) != 0) {
+		perror("Error opening batch.");
+		return NULL;
 	}
 
-	return min_i;
-}
+	if (S_ISDIR(st.st_mode)) {
+		DIR * dir = opendir(input);
+		struct dirent * entry;
+		if (dir == NULL) {
+			perror("Error opening batch directory.");
+			return NULL;
+		}
+		while ((entry = readdir(dir)) != NULL) {
+			size_t len = strlen(entry->d_name);
+			if (len < 4 || strcmp(entry->d_name + len - 4, ".cnf") != 0) continue;
 
-// UNUSED most frequent non-determined literal
-int lit_choose_max_occur(bitstore * config)
-{
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
-
-	int max = 0;
-	int max_i = 0;
-
-	for (int i = 1; i <= n_vars; i++) {
-		if (ass_state(nconf, pconf, i) == 0b00) {
-			int n_occ_pos = var_occurrence_count(config, i);
-			int n_occ_neg = var_occurrence_count(config, -i);
-			if (n_occ_pos > max) {
-				max = n_occ_pos;
-				max_i = i;
-			}
-			if (n_occ_neg > max) {
-				max = n_occ_neg;
-				max_i = -i;
-			}
+			char * path = malloc(strlen(input) + len + 2);
+			sprintf(path, "%s/%s", input, entry->d_name);
+			batch_push(&items, &n, &cap, path);
 		}
+		closedir(dir);
+		qsort(items, n, sizeof * items, path_cmp);
 	}
-
-	return max_i;
-}
-
-// UNUSED least frequent non-determined literal
-int lit_choose_min_occur(bitstore * config)
-{
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
-
-	int min = n_clauses;
-	int min_i = 0;
-
-	for (int i = 1; i <= n_vars; i++) {
-		if (ass_state(nconf, pconf, i) == 0b00) {
-			int n_occ_pos = var_occurrence_count(config, i);
-			int n_occ_neg = var_occurrence_count(config, -i);
-			if (n_occ_pos < min) {
-				min = n_occ_pos;
-				min_i = i;
-			}
-			if (n_occ_neg < min) {
-				min = n_occ_neg;
-				min_i = -i;
-			}
+	else {
+		FILE * fp = fopen(input, "r");
+		char buffer[4096];
+		if (fp == NULL) {
+			perror("Error opening batch list.");
+			return NULL;
+		}
+		while (fgets(buffer, sizeof buffer, fp) != NULL) {
+			buffer[strcspn(buffer, "\r\n")] = '\0';
+			if (*buffer == '\0' || *buffer == '#') continue;
+			batch_push(&items, &n, &cap, strdup(buffer));
 		}
+		fclose(fp);
 	}
 
-	return min_i;
+	*n_items = n;
+	return items;
 }
 
-/* An important function counting the occurrences, and
- * calculating a power measure for a given literal.
- * Power is the number of clauses in which this literal
- * exists along with one and only one another literal.
- *
- * Importance of power is that, if this literal is set
- * to be False, then the other literal in the clause will
- * be a unit literal, causing further propagations.
- */
-pair lit_oc_and_p(bitstore * config, int lit)
+// Output of an item is named after its file, without the directories and .cnf
+char * batch_out_path(const char * out_dir, const char * path)
 {
-	bitstore * cconf = config;
-	bitstore * occurlist = occurlists[lit];
-	pair cp = { 0, 0 };
-
-	for (int i = 0; i < cconf_len; i++) {
-		bitstore occ = ~cconf[i] & occurlist[i];
-		while (occ) {
-			int pos = least_bit_pos(occ);
-			cp.a++;
-			if (clause_length(config, i * 8 * sizeof occ + pos) == 2)
-				cp.b++;
-			occ &= ~bit(pos);
-		}
-	}
+	const char * name = strrchr(path, '/');
+	name = (name == NULL) ? path : name + 1;
+
+	size_t len = strlen(name);
+	if (len >= 4 && strcmp(name + len - 4, ".cnf") == 0) len -= 4;
 
-	return cp;
+	char * out = malloc(strlen(out_dir) + len + 6);
+	sprintf(out, "%s/%.*s.out", out_dir, (int) len, name);
+	return out;
 }
 
-/* [USED!] Literal with the highest score.
- * Score for a literal is the sum of:
- *   - Number of clauses in which the literal
- *     occurs
- *   - (f)actor times the power of the negative
- *     of the literal where (f)actor is current
- *     estimate for mean occurrence count of a
- *     variable
- *   - The above two for the negative of the
- *     literal, multiplied by 0.75
- * 
- * The rationale behind the score is:
- *   - Number of occurrences of the literal itself
- *     will be the amount of clauses that will be
- *     cleaned up
- *   - Power of the literal will generate that many
- *     unit clauses, each one cleaning up (f)actor
- *     many clauses, and more
- *   - In case of wrong decision, the opposite
- *     should not be in bad condition, either
- */
-int lit_choose_max_occur_power(bitstore * config)
+void batch_solve(batch_job * job, batch_item * item)
 {
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
-
-	int max = -1;
-	int max_i = 0;
+	const options * opts = job->opts;
+	double start = monotonic_sec();
 
-	for (int var = 1; var <= n_vars; var++)
-	if (ass_state(nconf, pconf, var) == 0b00) {
-		pair cp_pos = lit_oc_and_p(config, var);
-		pair cp_neg = lit_oc_and_p(config, -var);
-		
-		int unsat_count = n_clauses - sat_count(config);
-		int f = round_pos(mean_occ_len * unsat_count / n_clauses);
-		int score_pos = cp_pos.a + f * cp_neg.b;
-		int score_neg = cp_neg.a + f * cp_pos.b;
+	FILE * fp = fopen(item->path, "r");
+	if (fp == NULL) {
+		item->error = 1, item->reason = "cannot be opened";
+		return;
+	}
 
-		int temp = score_pos;
-		score_pos += score_neg * 0.75;
-		score_neg += temp * 0.75;
+	formula * f = formula_new();
+	int ok = formula_read(f, fp);
+	fclose(fp);
+	if (!ok) {
+		item->error = 1, item->reason = "cannot be read";
+		formula_free(f);
+		return;
+	}
 
-		if (score_pos > max) max = score_pos, max_i = var;
-		if (score_neg > max) max = score_neg, max_i = -var;
+	result_key key;
+	dpll_result cached = TBD;
+	bitstore * model = NULL;
+	if (opts->results != NULL) {
+		result_key_of(f, &key);
+		cached = result_lookup(opts->results, f, &key, &model);
+	}
+	int * read = lits_as_read(f);
+	size_t read_len = f->lits_len;
+	if (opts->symmetry && cached == TBD)
+		formula_break_symmetry(f);
+	if (opts->cardinality && cached == TBD)
+		formula_find_cardinality(f);
+	if (cached == TBD)
+		vivify(f, opts, NULL, NULL);
+
+	solver s;
+	solver_init(&s, f);
+	solver_setup(&s, opts);
+
+	item->result = (cached != TBD) ? cached : solver_solve(&s, NULL, 0, &model);
+	item->reason = s.stop_reason;
+
+	if (item->result == SUCCESS && opts->verify && verify_clauses(f, model, read, read_len)) {
+		item->reason = "model failed verification";
+		item->result = TBD;
+	}
+	free(read);
+	if (opts->results != NULL && cached == TBD && item->result != TBD)
+		result_store(opts->results, opts->results_size, f, &key, item->result, model);
+
+	char * out_path = batch_out_path(job->out_dir, item->path);
+	FILE * fw = fopen(out_path, "w");
+	if (fw == NULL)
+		item->error = 1, item->reason = "output cannot be written";
+	else {
+		if (item->result == TBD) fprintf(fw, "c %s\n", item->reason);
+		print_competition(f, item->result, model, fw);
+		if (ferror(fw) | fclose(fw))
+			item->error = 1, item->reason = "output cannot be written";
 	}
 
-	return max_i;
+	item->time = monotonic_sec() - start;
+	item->decisions = s.n_decisions;
+	item->conflicts = s.n_conflicts;
+	item->flips = s.n_flips;
+
+	free(out_path);
+	free(model);
+	solver_clean(&s);
+	formula_free(f);
 }
 
-// Sanity check for debugging purposes under failure
-void sanity(bitstore * config)
+void * batch_worker(void * arg)
 {
-	bitstore * cconf = config;
-	bitstore * nconf = config + cconf_len;
-	bitstore * pconf = nconf + olconf_len;
-
-	for (int i = 1; i <= n_clauses; i++) {
-		bitstore * pclause = clauses[i];
-		bitstore * nclause = clauses[-i];
-		int ok = 0;
-		if (is_s_set(cconf, i)) {
-			for (int j = 0; j < olconf_len; j++) {
-				if (pclause[j] & pconf[j] || nclause[j] & nconf[j]) {
-					ok = 1;
-					break;
-				}
-			}
-			if (!ok)
-				printf("insanity: c%d satisfied, no lits of it is true\n", i);
+	batch_job * job = arg;
+	const char * results[] = { "UNKNOWN", "UNSAT", "SAT" };
+
+	for (;;) {
+		pthread_mutex_lock(&job->lock);
+		size_t i = job->next++;
+		pthread_mutex_unlock(&job->lock);
+		if (i >= job->n_items) break;
+
+		batch_item * item = &job->items[i];
+		batch_solve(job, item);
+
+		pthread_mutex_lock(&job->lock);
+		if (item->error) {
+			job->errors++;
+			printf("%s%s: ERROR (%s)\n", job->prefix, item->path, item->reason);
 		}
 		else {
-			ok = 1;
-			for (int j = 0; j < olconf_len; j++) {
-				if (pclause[j] & pconf[j] || nclause[j] & nconf[j]) {
-					ok = 0;
-					printf("insanity: c%d unsat, with some lits true\n", i);
-					break;
-				}
-			}
-		}
-
-		if (!ok) {
-			puts("something's not ok");
+			job->counts[item->result]++;
+			printf("%s%s: %s in %fs", job->prefix, item->path, results[item->result], item->time);
+			if (item->result == TBD) printf(" (%s)", item->reason);
+			putchar('\n');
 		}
+		fflush(stdout);
+		pthread_mutex_unlock(&job->lock);
 	}
+
+	return NULL;
 }
 
-/* Recursive approach to the SAT problem
- * used by the depth-first searcher.
- */
-bitstore * dpll_rec(bitstore * config)
+int write_summary(const batch_job * job)
 {
-	if (!c_len_reductions(config)) {
-		free(config);
-		return NULL;
-	}
-	purity_reduction(config);
-	if (all_satisfied(config)) return config;
+	const char * results[] = { "UNKNOWN", "UNSAT", "SAT" };
+	char * path = malloc(strlen(job->out_dir) + 14);
+	sprintf(path, "%s/summary.csv", job->out_dir);
 
-	bitstore * configA = copy_config(config);
-	bitstore * configB = config;
-
-	int choice = lit_choose_max_occur_power(config);
-	if (choice == 0) {
-#if DEBUG
-		puts("This shouldn't happen.");
-		sanity(config);
-#endif
-		free(config);
-		return NULL;
+	FILE * fp = fopen(path, "w");
+	free(path);
+	if (fp == NULL) {
+		perror("Error opening summary to write.");
+		return 0;
 	}
 
-	lit_assign(configA, choice);
-	configA = dpll_rec(configA);
-	if (configA) {
-		free(configB);
-		return configA;
+	fputs("instance,result,time,decisions,conflicts,flips,reason\n", fp);
+	for (size_t i = 0; i < job->n_items; i++) {
+		const batch_item * item = &job->items[i];
+		fprintf(fp, "%s,%s,%f,%llu,%llu,%llu,%s\n", item->path,
+			item->error ? "ERROR" : results[item->result], item->time,
+			item->decisions, item->conflicts, item->flips, item->reason ? item->reason : "");
 	}
 
-	lit_assign(configB, -choice);
-	return dpll_rec(configB);
-}
-
-/* Depth-first SAT solver, uses less memory
- * but takes more time.
- */
-bitstore * dpll_depth(void)
-{
-	bitstore * config = calloc(cfg_len, sizeof * config);
-	return dpll_rec(config);
+	if (ferror(fp) | fclose(fp)) {
+		perror("Error writing summary.");
+		return 0;
+	}
+	return 1;
 }
 
-/* Makes a DPLL configuration advance by a step,
- * results in FAIL, SUCCESS, or TBD (to-be-determined).
+/* Solves every formula of the batch, returning the exit code:
+ * 0 if all were read and written, -1 otherwise.
  */
-dpll_result dpll_step(bitstore * config)
+int solve_batch(const options * opts)
 {
-	if (!c_len_reductions(config))
-		return FAIL;
-	purity_reduction(config);
-	if (all_satisfied(config))
-		return SUCCESS;
-
-	return TBD;
-}
+	batch_job job = { opts, opts->solution };
+	job.prefix = opts->competition ? "c " : "";
 
-/* Breadth-first SAT solver, uses more memory
- * but takes less time, whenever the problem is SAT.
- */
-bitstore * dpll_breadth(void)
-{
-	size_t length = (1ULL << 18) / cfg_size;
-	bitstore * prealloc = malloc(length * cfg_size);
-	dpll_result * results = malloc(length * sizeof * results);
+	if (mkdir(job.out_dir, 0777) != 0 && errno != EEXIST) {
+		perror("Error creating output directory.");
+		return -1;
+	}
 
-	if (prealloc == NULL || results == NULL) {
-		fprintf(stderr, "Need more memory than system allows.\n");
-		return NULL;
+	if ((job.items = read_batch(opts->problem, &job.n_items)) == NULL) {
+		fputs("Batch couldn't be read, or is empty\n", stderr);
+		return -1;
 	}
 
-	memset(prealloc, 0, length * cfg_size);
-	results[0] = TBD;
+	pthread_mutex_init(&job.lock, NULL);
 
-	int nTBD = 1;
-	int last = 1;
+	int n_threads = (opts->jobs < job.n_items) ? opts->jobs : job.n_items;
+	pthread_t * threads = malloc(n_threads * sizeof * threads);
+	for (int t = 1; t < n_threads; t++)
+		pthread_create(&threads[t], NULL, batch_worker, &job);
+	batch_worker(&job);
+	for (int t = 1; t < n_threads; t++)
+		pthread_join(threads[t], NULL);
 
-	// continue until all become FAILs and one becomes SUCCESS
-	// last will remain the same, if all none turned out TBD or SUCCESS
-	while (nTBD) {
-		if (nTBD < last / 2 || last > length / 2) {
-#if DEBUG
-			int old_last = last;
-#endif
-			last--;
-			for (int i = 0; i <= last; i++) if (results[i] == FAIL) {
-				memcpy(prealloc + i * cfg_len, prealloc + last-- * cfg_len, cfg_size);
-				results[i] = TBD; // we know it's not FAIL nor SUCCESS
-				while (results[last] == FAIL) last--;
-			}
-			last++;
-#if DEBUG
-			printf("Consolidation by %.2f%%\n", 100.0 * last / old_last);
-#endif
-		}
-		if (last > length / 2) {
-			length *= 2;
-			prealloc = realloc(prealloc, length * cfg_size);
-			results = realloc(results, length * sizeof * results);
-#if DEBUG
-			printf("size increase!\n");
-#endif
-			if (prealloc == NULL || results == NULL) {
-				fprintf(stderr, "Need more memory than system allows.\n");
-				return NULL;
-			}
-		}
+	printf("%sBatch: %zu satisfiable, %zu unsatisfiable, %zu unknown, %zu errors\n", job.prefix,
+		job.counts[SUCCESS], job.counts[FAIL], job.counts[TBD], job.errors);
 
-		nTBD = 0;
-
-		for (int i = last - 1; i >= 0; i--) if (results[i] == TBD) {
-			bitstore * exhibit = prealloc + i * cfg_len;
-			bitstore * exhibitA;
-			bitstore * exhibitB;
-			int choice;
-
-			switch (results[i] = dpll_step(exhibit)) {
-				case TBD:
-					choice = lit_choose_max_occur_power(exhibit);
-					if (choice != 0) {
-						exhibitA = exhibit;
-						exhibitB = memcpy(prealloc + last * cfg_len, exhibit, cfg_size);
-
-						lit_assign(exhibitA, choice);
-						lit_assign(exhibitB, -choice);
-
-						results[last++] = TBD;
-						nTBD += 2;
-
-						break;
-					}
-
-					results[i] = FAIL;
-					puts("This shouldn't happen.");
-				case FAIL:
-					break;
-				case SUCCESS:
-					exhibit = copy_config(exhibit);
-					free(prealloc);
-					free(results);
-					return exhibit;
-			}
-		}
-	}
+	int ok = write_summary(&job) && job.errors == 0;
 
-	free(prealloc);
-	free(results);
-	return NULL;
-}
+	pthread_mutex_destroy(&job.lock);
+	free(threads);
+	for (size_t i = 0; i < job.n_items; i++)
+		free(job.items[i].path);
+	free(job.items);
 
-double ts_to_sec(struct timespec t)
-{
-	return t.tv_sec + t.tv_nsec * 1e-9;
+	return ok ? 0 : -1;
 }
 
 int main(int argc, char const *argv[])
 {
-	struct timespec tstart, tend;
-	clock_gettime(CLOCK_REALTIME, &tstart);
+	double start = monotonic_sec();
 
-	if (argc < 2) {
-		fprintf(stderr, "Usage: %s problem.cnf\n", argv[0]);
+	options opts;
+	if (!parse_options(argc, argv, &opts)) {
+		usage(argv[0]);
 		return -1;
 	}
 
-	FILE * fp = fopen(argv[1], "r");
+	if (opts.batch) {
+		if (opts.check || opts.count || opts.cubes != NULL || opts.checkpoint != NULL
+			|| opts.resume != NULL || opts.proof != NULL) {
+			fputs("Batches can only be solved, without checkpoints or proofs\n", stderr);
+			return -1;
+		}
+		signal(SIGINT, on_signal);
+		signal(SIGTERM, on_signal);
+
+		int code = solve_batch(&opts);
+		printf("%sElapsed time: %fs\n", opts.competition ? "c " : "", monotonic_sec() - start);
+		return code;
+	}
+
+	FILE * fp = fopen(opts.problem, "r");
 	if (fp == NULL) {
 		perror("Error opening file.");
 		return -1;
 	}
 
 	FILE * fw = NULL;
-	if (argc == 3) {
-			fw = fopen(argv[2], "w");
+	if (opts.solution != NULL && !opts.check) {
+			fw = fopen(opts.solution, "w");
 			if (fw == NULL) {
 					perror("Error opening file to write.");
 					return -1;
 			}
 	}
 
-	if (!read(fp)) {
+	formula * f = formula_new();
+	solver s;
+	solver_init(&s, f);
+
+	if (!formula_read(f, fp)) {
 		fputs("Formula couldn't be read\n", stderr);
 		return -1;
 	}
+#ifdef STATS
+	s.stats.phase_time[PHASE_PARSE] = monotonic_sec() - start;
+#endif
 
-	bitstore * config = dpll_breadth();
+	if (opts.check) {
+		int failed = check_solution(f, opts.solution);
+		formula_free(f);
+		return failed;
+	}
 
-	if (config == NULL) {
-		puts("Unsatisfiable.");
+	if (opts.cubes != NULL) {
+		// a cube may only have models that symmetry breaking rules out
+		if (opts.count || opts.symmetry || opts.cardinality || opts.checkpoint != NULL || opts.resume != NULL || opts.proof != NULL) {
+			fputs("Cubes cannot be counted, checkpointed, resumed, proven, broken of symmetries or given cardinality constraints\n", stderr);
+			return -1;
+		}
+		int * read = lits_as_read(f);
+		size_t read_len = f->lits_len;
+		vivify(f, &opts, NULL, opts.competition ? "c " : "");
+		signal(SIGINT, on_signal);
+		signal(SIGTERM, on_signal);
+
+		int code = solve_cubes(f, read, read_len, &opts, fw);
+		free(read);
+		if (fw != NULL) fclose(fw);
+		solver_clean(&s);
+		formula_free(f);
+		printf("%sElapsed time: %fs\n", opts.competition ? "c " : "", monotonic_sec() - start);
+		return code;
 	}
-	else {
-		puts("Satisfiable!");
-		print_assignments(config, (fw == NULL) ? stdout : fw);
-		free(config);
+
+	if (opts.count) {
+		if (opts.sls != SLS_NONE || opts.symmetry || opts.cardinality || opts.checkpoint != NULL || opts.resume != NULL || opts.proof != NULL) {
+			fputs("Models can only be counted by DPLL, without symmetry breaking, cardinality constraints, checkpoints or proofs\n", stderr);
+			return -1;
+		}
+		vivify(f, &opts, NULL, opts.competition ? "c " : "");
+		solver_setup(&s, &opts);
+		signal(SIGINT, on_signal);
+		signal(SIGTERM, on_signal);
+
+		bignum count;
+		bignum_init(&count);
+		dpll_result result = solver_count(&s, NULL, 0, &count);
+		const char * prefix = opts.competition ? "c " : "";
+
+		if (result == TBD)
+			printf(opts.competition ? "c %s\ns UNKNOWN\n" : "Unknown: %s.\n", s.stop_reason);
+		else {
+			char * str = bignum_str(&count);
+			if (opts.competition)
+				printf("s %s\nc s mc %s\n", result == SUCCESS ? "SATISFIABLE" : "UNSATISFIABLE", str);
+			else
+				printf("Models: %s\n", str);
+			free(str);
+		}
+		bignum_free(&count);
+
+		stats_print(&s, prefix);
+		solver_clean(&s);
+		formula_free(f);
+		printf("%sElapsed time: %fs\n", prefix, monotonic_sec() - start);
+
+		switch (result) {
+			case SUCCESS: return 10;
+			case FAIL:    return 20;
+			default:      return 0;
+		}
+	}
+
+	if (opts.sls != SLS_NONE && (opts.checkpoint != NULL || opts.resume != NULL || opts.proof != NULL)) {
+		fputs("Local search cannot be checkpointed, resumed or proven\n", stderr);
+		return -1;
 	}
 
-	clean_formula();
+	// a cached result is the answer, unless a proof of it is asked for
+	result_key key;
+	dpll_result cached = TBD;
+	bitstore * config = NULL;
+	if (opts.results != NULL) {
+		result_key_of(f, &key);
+		if (opts.proof == NULL)
+			cached = result_lookup(opts.results, f, &key, &config);
+	}
 
-	clock_gettime(CLOCK_REALTIME, &tend);
-	printf("Elapsed time: %fs\n", ts_to_sec(tend) - ts_to_sec(tstart));
+	// preprocessing rewrites the clauses, the model is verified against these
+	int * read = lits_as_read(f);
+	size_t read_len = f->lits_len;
 
-	return 0;
+	// clauses breaking symmetries follow from no clauses of the formula
+	if (opts.symmetry && cached == TBD) {
+		if (opts.proof != NULL) {
+			fputs("Proofs cannot be made with symmetry breaking\n", stderr);
+			return -1;
+		}
+		double sym_start = monotonic_sec();
+		unsigned int n_clauses = f->n_clauses;
+		unsigned int n_gens = formula_break_symmetry(f);
+		printf("%sSymmetries: %u generators, %u clauses added in %fs\n", opts.competition ? "c " : "",
+			n_gens, f->n_clauses - n_clauses, monotonic_sec() - sym_start);
+	}
+
+	// the constraints are propagated by counting, which makes no lemmas
+	if (opts.cardinality && cached == TBD) {
+		if (opts.proof != NULL || opts.sls != SLS_NONE) {
+			fputs("Cardinality constraints cannot be proven or searched locally\n", stderr);
+			return -1;
+		}
+		unsigned int n_clauses = f->n_clauses;
+		unsigned int n_cards = formula_find_cardinality(f);
+		printf("%sCardinality: %u constraints replacing %u clauses\n", opts.competition ? "c " : "",
+			n_cards, n_clauses - f->n_clauses);
+	}
+
+	s.ckpt_path = opts.checkpoint;
+	s.ckpt_interval = opts.checkpoint_interval;
+	s.resume_path = opts.resume;
+
+	// the checkpoint decides which searcher resumes it
+	if (s.resume_path != NULL) {
+		int kind = ckpt_probe(&s);
+		if (kind < 0) {
+			fputs("Search couldn't be resumed\n", stderr);
+			return -1;
+		}
+		opts.depth_first = kind == DEPTH_FIRST;
+	}
+
+	// only the depth-first searcher knows the decisions leading to a node
+	if (opts.proof != NULL) {
+		if (s.resume_path != NULL) {
+			fputs("Proofs cannot be resumed from a checkpoint\n", stderr);
+			return -1;
+		}
+		if ((s.proof = proof_open(opts.proof, !opts.proof_text, f)) == NULL)
+			return -1;
+		opts.depth_first = 1;
+	}
+
+	// after the proof is open, for the clauses it replaces to be in it
+	if (cached == TBD)
+		vivify(f, &opts, s.proof, opts.competition ? "c " : "");
+
+	solver_setup(&s, &opts);
+	s.threads = opts.jobs; // of a single formula, for its components
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+
+#ifndef STATS
+	if (opts.progress)
+		fputs("Statistics are compiled out, no progress will be printed\n", stderr);
+#endif
+
+#ifdef PROFILE
+	prof_init();
+	if (opts.trace != NULL && !trace_open(opts.trace))
+		return -1;
+#else
+	if (opts.trace != NULL)
+		fputs("Profiling is compiled out, no trace will be written\n", stderr);
+#endif
+
+	dpll_result result = (cached != TBD) ? cached : solver_solve(&s, NULL, 0, &config);
+
+	if (s.proof != NULL)
+		proof_close(s.proof);
+#ifdef PROFILE
+	if (opts.trace != NULL)
+		trace_close();
+#endif
+
+	// a model that fails verification is no answer at all
+	if (result == SUCCESS && opts.verify) {
+		unsigned int failed = verify_clauses(f, config, read, read_len);
+		if (failed) {
+			fprintf(stderr, "Model does not satisfy clause %u.\n", failed);
+			s.stop_reason = "model failed verification";
+			result = TBD;
+		}
+	}
+	free(read);
+
+	if (opts.results != NULL && cached == TBD && result != TBD)
+		result_store(opts.results, opts.results_size, f, &key, result, config);
+
+	// anything other than the result is a comment in the competition format
+	const char * prefix = opts.competition ? "c " : "";
+	if (cached != TBD)
+		printf("%sResult from the cache\n", prefix);
+
+	if (opts.competition) {
+		if (result == TBD) printf("c %s\n", s.stop_reason);
+		fflush(stdout);
+		print_competition(f, result, config, stdout);
+		if (result == SUCCESS && fw != NULL)
+			print_assignments(f, config, fw);
+	}
+	else switch (result) {
+		case FAIL:
+			puts("Unsatisfiable.");
+			break;
+		case SUCCESS:
+			puts("Satisfiable!");
+			fflush(stdout);
+			print_assignments(f, config, (fw == NULL) ? stdout : fw);
+			break;
+		case TBD:
+			printf("Unknown: %s.\n", s.stop_reason);
+			break;
+	}
+	free(config);
+
+	stats_print(&s, prefix);
+#ifdef PROFILE
+	prof_print(prefix);
+#endif
+
+	solver_clean(&s);
+	formula_free(f);
+
+	printf("%sElapsed time: %fs\n", prefix, monotonic_sec() - start);
+
+	// exit codes of the SAT competition
+	switch (result) {
+		case SUCCESS: return 10;
+		case FAIL:    return 20;
+		default:      return 0;
+	}
 }